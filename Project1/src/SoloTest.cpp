@@ -4,613 +4,5614 @@
 #include <iostream>
 #include <cmath>
 #include <stack>
+#include <deque>
 #include <queue>
 #include <algorithm>
 #include <random>
 #include <chrono>
 #include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-#define FREE -1
-#define WALL -2
-#define PEG 1
+#define FREE '.'
+#define WALL ' '
+#define PEG 'o'
+
+#define MAX_BOARD_SIZE 9
+/*
+ * The state key of a node keeps the hole of the last moved peg above
+ * the board bits (see Solver::stateKey), so a board has at most 56 holes:
+ */
+#define MAX_NUMBER_OF_HOLES 56
+#define MAX_NUMBER_OF_JUMPS 192
+#define MAX_NUMBER_OF_SYMMETRIES 8
+#define MAX_WEIGHT_PLANES 8
+#define TRANSPOSITION_TABLE_MB 128
+// The transposition table of a search takes at most this fraction of the memory budget:
+#define TRANSPOSITION_TABLE_BUDGET_SHARE 16
+#define MEMORY_BUDGET_MB 2048
+#define SPILL_MEMORY_NODES 1048576
+#define SPILL_SEGMENT_NODES 262144
+#define NUMBER_OF_BUCKETS 64
+#define BEAM_WIDTH 10000
+#define PORTFOLIO_TABLE_MB 8
+#define RESTART_NODES 4096
+#define CHECKPOINT_INTERVAL_SECONDS 60
+#define PROGRESS_INTERVAL_SECONDS 10
+#define WATCHDOG_TICK_MS 1
+#define SHARD_BATCH_BOARDS 4096
 
 using namespace std;
+
+/*
+ * A benchmark build with -DCOUNT_HEAP_ALLOCATIONS counts every heap
+ * allocation of the process, so a run can show that its search loop does
+ * not allocate for every expanded node. All of the replaceable forms of
+ * new and delete are replaced, so every pointer is freed by the function
+ * that allocated it. They are not inlined, so the compiler pairs the new
+ * and delete calls instead of the malloc and free calls inside them:
+ */
+#ifdef COUNT_HEAP_ALLOCATIONS
+atomic<long> numberOfHeapAllocations{0};
+
+void *countedMalloc(size_t size) noexcept
+{
+    numberOfHeapAllocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    if (void *memory = countedMalloc(size))
+        return memory;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new[](size_t size)
+{
+    if (void *memory = countedMalloc(size))
+        return memory;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new(size_t size, const nothrow_t &) noexcept
+{
+    return countedMalloc(size);
+}
+
+__attribute__((noinline)) void *operator new[](size_t size, const nothrow_t &) noexcept
+{
+    return countedMalloc(size);
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+// The over-aligned types, like WorkerTelemetry, use the aligned forms:
+void *countedAlignedMalloc(size_t size, align_val_t alignment) noexcept
+{
+    numberOfHeapAllocations.fetch_add(1, memory_order_relaxed);
+    size_t align = max(static_cast<size_t>(alignment), sizeof(void *));
+    // aligned_alloc needs a size that is a multiple of the alignment:
+    return aligned_alloc(align, (max<size_t>(size, 1) + align - 1) / align * align);
+}
+
+__attribute__((noinline)) void *operator new(size_t size, align_val_t alignment)
+{
+    if (void *memory = countedAlignedMalloc(size, alignment))
+        return memory;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    return countedAlignedMalloc(size, alignment);
+}
+
+__attribute__((noinline)) void *operator new[](size_t size, align_val_t alignment)
+{
+    if (void *memory = countedAlignedMalloc(size, alignment))
+        return memory;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    return countedAlignedMalloc(size, alignment);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, align_val_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t, align_val_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, align_val_t, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, align_val_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, size_t, align_val_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, align_val_t, const nothrow_t &) noexcept
+{
+    free(memory);
+}
+#endif
+
+/*
+ * A board state is stored as a 64-bit bitboard. The holes of a board are
+ * numbered row by row and the number of a hole is its bit, a set bit is a peg.
+ */
+typedef uint64_t Bitboard;
+
+constexpr Bitboard cellMask(int cell)
+{
+    return Bitboard(1) << cell;
+}
+
+inline int countPegs(Bitboard board)
+{
+    return __builtin_popcountll(board);
+}
+
+/*
+ * A jump moves the peg in the "from" hole over the peg in the "over" hole
+ * to the free "to" hole. Applying it to a board is a single xor with mask.
+ */
+struct Jump
+{
+    int from;
+    int over;
+    int to;
+    // from | over, both of them must be pegs before the jump:
+    Bitboard pegs;
+    // from | over | to
+    Bitboard mask;
+    // The change of the board weight, the pegs leave from and over and land on to:
+    int weightChange;
+};
+
+struct Cell
+{
+    int row;
+    int column;
+};
+
+/*
+ * Geometry describes a board variant. It is built at compile time from the
+ * layout of the initial board, so every variant has its own constant jump
+ * table, masks and goal board, and the search loops only read them.
+ */
+struct Geometry
+{
+    const char *name;
+    // The layout has the same number of rows and columns:
+    int size;
+    // The holes of a triangular board are in the lower left half of the layout:
+    bool isTriangular;
+    int numberOfHoles;
+    // The hole number of every row and column, -1 for the walls:
+    int holeIndex[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+    Cell cells[MAX_NUMBER_OF_HOLES];
+    // Mask of all the reachable holes on the board:
+    Bitboard holes;
+    Bitboard board;
+    // The optimal board has a single peg in the goal hole:
+    int goalHole;
+    Bitboard goal;
+    int numberOfJumps;
+    Jump jumps[MAX_NUMBER_OF_JUMPS];
+    // Heuristic weight of a peg in every hole (see Heuristic):
+    int weights[MAX_NUMBER_OF_HOLES];
+    /*
+     * The weights minus the smallest one split to bit planes, the weight of a
+     * board is minimumWeight * pegs plus 2^k * the pegs in the plane k:
+     */
+    int minimumWeight;
+    int numberOfWeightPlanes;
+    Bitboard weightPlanes[MAX_WEIGHT_PLANES];
+    // The rotations and reflections of the board which keep the goal hole in its place:
+    int numberOfSymmetries;
+    int symmetries[MAX_NUMBER_OF_SYMMETRIES][MAX_NUMBER_OF_HOLES];
+    // All of the rotations and reflections of the board, whatever the goal is:
+    int numberOfBoardSymmetries;
+    int boardSymmetries[MAX_NUMBER_OF_SYMMETRIES][MAX_NUMBER_OF_HOLES];
+};
+
+/*
+ * Moves a cell with one of the 8 rotations and reflections of a square
+ * board, or one of the 6 of a triangular board. The cells of a triangle
+ * are turned by permuting their distances to its three sides.
+ */
+constexpr Cell transformCell(int symmetry, Cell cell, int size, bool isTriangular)
+{
+    int i = cell.row;
+    int j = cell.column;
+    int last = size - 1;
+    if (isTriangular == true)
+    {
+        int x = j;
+        int y = i - j;
+        int z = last - i;
+        int distances[6][3] = {{x, y, z}, {y, z, x}, {z, x, y}, {y, x, z}, {x, z, y}, {z, y, x}};
+        return {last - distances[symmetry][2], distances[symmetry][0]};
+    }
+    switch (symmetry)
+    {
+    case 1:
+        return {j, last - i};
+    case 2:
+        return {last - i, last - j};
+    case 3:
+        return {last - j, i};
+    case 4:
+        return {i, last - j};
+    case 5:
+        return {last - i, j};
+    case 6:
+        return {j, i};
+    case 7:
+        return {last - j, last - i};
+    default:
+        return {i, j};
+    }
+}
+
+/*
+ * The heuristic weight of a peg in a hole,
+ * a board with lower total weight is more promising (see Heuristic).
+ */
+constexpr int pegWeight(Geometry &geometry, int hole, Bitboard corners, Bitboard goalArea)
+{
+    /*
+     * Calculating the squared oclidean distances of the pegs
+     * to the goal hole (closer is better):
+     */
+    int i = geometry.cells[hole].row - geometry.cells[geometry.goalHole].row;
+    int j = geometry.cells[hole].column - geometry.cells[geometry.goalHole].column;
+    int weight = i * i + j * j;
+
+    /*
+     * The pegs in the corners should be avoided.Because
+     * the pegs in the corners cannot be removed easily.
+     * These are the holes that no jump can pass over.
+     */
+    if ((corners & cellMask(hole)) != 0)
+    {
+        weight += 2;
+    }
+
+    /*
+     * Checking if the blocks around the goal have a peg or not.
+     * This helps to get to the optimal solution by checking if
+     * any of these blocks have one peg to handle the final move
+     * towards to the goal block.
+     */
+    if ((goalArea & cellMask(hole)) != 0)
+    {
+        weight -= 10;
+    }
+    return weight;
+}
+
+/*
+ * Builds the parts of the geometry that depend on the goal hole: the
+ * weights of the pegs and the symmetries. A board variant can be played
+ * towards another goal hole by calling it again.
+ */
+constexpr void setGoal(Geometry &geometry, int goalHole)
+{
+    geometry.goalHole = goalHole;
+    geometry.goal = cellMask(goalHole);
+    Bitboard jumpedHoles = 0;
+    for (int k = 0; k < geometry.numberOfJumps; k++)
+    {
+        jumpedHoles |= cellMask(geometry.jumps[k].over);
+    }
+
+    Bitboard goalArea = geometry.goal;
+    for (int k = 0; k < geometry.numberOfJumps; k++)
+    {
+        if (geometry.jumps[k].to == geometry.goalHole)
+            goalArea |= cellMask(geometry.jumps[k].from);
+    }
+    for (int hole = 0; hole < geometry.numberOfHoles; hole++)
+    {
+        geometry.weights[hole] = pegWeight(geometry, hole, geometry.holes & ~jumpedHoles, goalArea);
+    }
+    for (int k = 0; k < geometry.numberOfJumps; k++)
+    {
+        Jump &jump = geometry.jumps[k];
+        jump.weightChange = geometry.weights[jump.to] - geometry.weights[jump.from] - geometry.weights[jump.over];
+    }
+    geometry.minimumWeight = geometry.weights[0];
+    for (int hole = 0; hole < geometry.numberOfHoles; hole++)
+    {
+        geometry.minimumWeight = min(geometry.minimumWeight, geometry.weights[hole]);
+    }
+    geometry.numberOfWeightPlanes = 0;
+    for (int k = 0; k < MAX_WEIGHT_PLANES; k++)
+    {
+        geometry.weightPlanes[k] = 0;
+    }
+    for (int hole = 0; hole < geometry.numberOfHoles; hole++)
+    {
+        int weight = geometry.weights[hole] - geometry.minimumWeight;
+        for (int k = 0; weight >> k != 0; k++)
+        {
+            if ((weight >> k & 1) != 0)
+                geometry.weightPlanes[k] |= cellMask(hole);
+            geometry.numberOfWeightPlanes = max(geometry.numberOfWeightPlanes, k + 1);
+        }
+    }
+
+    /*
+     * Symmetric boards have the same subtrees only if the symmetry
+     * keeps the goal hole in its place, the others are not used:
+     */
+    geometry.numberOfSymmetries = 0;
+    for (int symmetry = 0; symmetry < geometry.numberOfBoardSymmetries; symmetry++)
+    {
+        if (geometry.boardSymmetries[symmetry][goalHole] != goalHole)
+            continue;
+        for (int hole = 0; hole < geometry.numberOfHoles; hole++)
+        {
+            geometry.symmetries[geometry.numberOfSymmetries][hole] = geometry.boardSymmetries[symmetry][hole];
+        }
+        geometry.numberOfSymmetries++;
+    }
+}
+
+/*
+ * The layout has a row of "size" characters for every row of the board, WALL
+ * for the unreachable cells, PEG for the pegs and FREE for the free holes.
+ */
+constexpr Geometry createGeometry(const char *name, const char *const *layout, int size,
+                                  bool isTriangular, int goalRow, int goalColumn)
+{
+    Geometry geometry = {};
+    geometry.name = name;
+    geometry.size = size;
+    geometry.isTriangular = isTriangular;
+    for (int i = 0; i < MAX_BOARD_SIZE; i++)
+    {
+        for (int j = 0; j < MAX_BOARD_SIZE; j++)
+        {
+            geometry.holeIndex[i][j] = -1;
+            if (i >= size || j >= size || layout[i][j] == WALL)
+                continue;
+            int hole = geometry.numberOfHoles++;
+            geometry.holeIndex[i][j] = hole;
+            geometry.cells[hole] = {i, j};
+            geometry.holes |= cellMask(hole);
+            if (layout[i][j] == PEG)
+                geometry.board |= cellMask(hole);
+        }
+    }
+
+    /*
+     * The jump table is ordered by the target hole and then by the move
+     * direction, which is the same order the moves were searched on the
+     * old two dimensional board. So the frontier orderings do not change.
+     * The pegs of a triangular board can also jump along one of the diagonals.
+     */
+    int moves[6][2] = {{-2, 0}, {2, 0}, {0, -2}, {0, 2}, {-2, -2}, {2, 2}};
+    for (int to = 0; to < geometry.numberOfHoles; to++)
+    {
+        for (int move = 0; move < (isTriangular == true ? 6 : 4); move++)
+        {
+            int fromRow = geometry.cells[to].row + moves[move][0];
+            int fromColumn = geometry.cells[to].column + moves[move][1];
+            int overRow = geometry.cells[to].row + moves[move][0] / 2;
+            int overColumn = geometry.cells[to].column + moves[move][1] / 2;
+            if (fromRow < 0 || fromRow >= size || fromColumn < 0 || fromColumn >= size ||
+                geometry.holeIndex[fromRow][fromColumn] == -1)
+                continue;
+            Jump &jump = geometry.jumps[geometry.numberOfJumps++];
+            jump.from = geometry.holeIndex[fromRow][fromColumn];
+            jump.over = geometry.holeIndex[overRow][overColumn];
+            jump.to = to;
+            jump.pegs = cellMask(jump.from) | cellMask(jump.over);
+            jump.mask = jump.pegs | cellMask(jump.to);
+        }
+    }
+
+    // A rotation or reflection is a symmetry of the board if it moves every hole to a hole:
+    for (int symmetry = 0; symmetry < (isTriangular == true ? 6 : 8); symmetry++)
+    {
+        int *permutation = geometry.boardSymmetries[geometry.numberOfBoardSymmetries];
+        bool isValid = true;
+        for (int hole = 0; hole < geometry.numberOfHoles; hole++)
+        {
+            Cell target = transformCell(symmetry, geometry.cells[hole], size, isTriangular);
+            if (target.row < 0 || target.row >= size || target.column < 0 || target.column >= size ||
+                geometry.holeIndex[target.row][target.column] == -1)
+            {
+                isValid = false;
+                break;
+            }
+            permutation[hole] = geometry.holeIndex[target.row][target.column];
+        }
+        if (isValid == true)
+            geometry.numberOfBoardSymmetries++;
+    }
+    setGoal(geometry, geometry.holeIndex[goalRow][goalColumn]);
+    return geometry;
+}
+
+constexpr const char *ENGLISH_LAYOUT[] = {
+    "  ooo  ",
+    "  ooo  ",
+    "ooooooo",
+    "ooo.ooo",
+    "ooooooo",
+    "  ooo  ",
+    "  ooo  "};
+
+/*
+ * The European (French) board has 4 more holes between the arms. The game
+ * with the center hole cannot end with a single peg on it, so it starts
+ * with a free top corner and ends on the left of the center.
+ */
+constexpr const char *EUROPEAN_LAYOUT[] = {
+    "  .oo  ",
+    " ooooo ",
+    "ooooooo",
+    "ooooooo",
+    "ooooooo",
+    " ooooo ",
+    "  ooo  "};
+
+// Wiegleb's board has longer arms:
+constexpr const char *WIEGLEB_LAYOUT[] = {
+    "   ooo   ",
+    "   ooo   ",
+    "   ooo   ",
+    "ooooooooo",
+    "oooo.oooo",
+    "ooooooooo",
+    "   ooo   ",
+    "   ooo   ",
+    "   ooo   "};
+
+constexpr const char *TRIANGULAR_LAYOUT[] = {
+    ".    ",
+    "oo   ",
+    "ooo  ",
+    "oooo ",
+    "ooooo"};
+
+constexpr Geometry ENGLISH = createGeometry("english", ENGLISH_LAYOUT, 7, false, 3, 3);
+constexpr Geometry EUROPEAN = createGeometry("european", EUROPEAN_LAYOUT, 7, false, 3, 1);
+constexpr Geometry WIEGLEB = createGeometry("wiegleb", WIEGLEB_LAYOUT, 9, false, 4, 4);
+constexpr Geometry TRIANGULAR = createGeometry("triangular", TRIANGULAR_LAYOUT, 5, true, 0, 0);
+constexpr const Geometry *GEOMETRIES[] = {&ENGLISH, &EUROPEAN, &WIEGLEB, &TRIANGULAR};
+
+/*
+ * A problem of the batch mode is a board variant with a single free hole
+ * and another goal hole, it is built from the variant when it is read:
+ */
+constexpr Geometry createProblem(const Geometry &geometry, int startHole, int goalHole)
+{
+    Geometry problem = geometry;
+    problem.board = geometry.holes & ~cellMask(startHole);
+    setGoal(problem, goalHole);
+    return problem;
+}
+
+/*
+ * The holes are named with the column letter and the row number
+ * of the layout, so the center of the English board is d4:
+ */
+string cellName(const Geometry &geometry, int hole)
+{
+    return char('a' + geometry.cells[hole].column) + to_string(geometry.cells[hole].row + 1);
+}
+
+// Returns the hole of the name or -1 if it is not a hole of the board:
+int parseCell(const Geometry &geometry, const string &name)
+{
+    if (name.size() < 2 || name[0] < 'a' || isdigit(name[1]) == false)
+        return -1;
+    int column = name[0] - 'a';
+    int row = atoi(name.c_str() + 1) - 1;
+    if (row < 0 || row >= geometry.size || column >= geometry.size)
+        return -1;
+    return geometry.holeIndex[row][column];
+}
+
 /*
  * SoloTest board initializator class
  */
 class SoloTest
 {
 public:
-    vector<vector<int>> board;
-    // Possible moves from a free block:
-    vector<pair<int, int>> moves = {{-2, 0}, {2, 0}, {0, -2}, {0, 2}};
-    void createBoard()
+    const Geometry *geometry = nullptr;
+    Bitboard board = 0;
+    // Mask of all the reachable holes on the board:
+    Bitboard holes = 0;
+    Bitboard goal = 0;
+    int numberOfHoles = 0;
+    // All of the legal jumps of the board:
+    vector<Jump> jumps;
+
+    void createBoard(const Geometry &geometry = ENGLISH)
+    {
+        this->geometry = &geometry;
+        board = geometry.board;
+        holes = geometry.holes;
+        goal = geometry.goal;
+        numberOfHoles = geometry.numberOfHoles;
+        jumps.assign(geometry.jumps, geometry.jumps + geometry.numberOfJumps);
+    }
+
+    bool isHole(int row, int column)
+    {
+        return row >= 0 && row < geometry->size && column >= 0 && column < geometry->size &&
+               geometry->holeIndex[row][column] != -1;
+    }
+
+    // The total weight of all the pegs of a board:
+    int boardWeight(Bitboard board)
+    {
+        int weight = 0;
+        for (Bitboard pegs = board; pegs != 0; pegs &= pegs - 1)
+            weight += geometry->weights[__builtin_ctzll(pegs)];
+        return weight;
+    }
+
+    // The weights of count boards, four boards at a time if the processor has AVX2:
+    void boardWeights(const Bitboard *boards, size_t count, int *weights)
+    {
+        size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+        static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+        if (hasAVX2 == true)
+            done = boardWeightsAVX2(boards, count, weights);
+#endif
+        for (size_t i = done; i < count; i++)
+        {
+            weights[i] = boardWeight(boards[i]);
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    /*
+     * The popcount of the four 64 bit lanes: every byte is counted by two
+     * lookups of its nibbles and the bytes of a lane are summed by sad.
+     */
+    __attribute__((target("avx2"))) static __m256i countPegs4(__m256i boards)
+    {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(boards, nibble));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(boards, 4), nibble));
+        return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+    }
+
+    // Returns the number of the boards that are weighted, a multiple of four:
+    __attribute__((target("avx2"))) size_t boardWeightsAVX2(const Bitboard *boards, size_t count, int *weights)
     {
-        if (board.empty() == false)
+        const __m256i minimum = _mm256_set1_epi64x(geometry->minimumWeight);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
         {
-            board.clear();
+            __m256i four = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(boards + i));
+            __m256i total = _mm256_mul_epi32(countPegs4(four), minimum);
+            for (int k = 0; k < geometry->numberOfWeightPlanes; k++)
+            {
+                __m256i plane = _mm256_and_si256(four, _mm256_set1_epi64x(geometry->weightPlanes[k]));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(countPegs4(plane), k));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                weights[i + lane] = static_cast<int>(lanes[lane]);
+            }
         }
-        // FREE represents the free pegs and WALL represents the unreachable indexes:
-        board.push_back({WALL, WALL, PEG, PEG, PEG, WALL, WALL});
-        board.push_back({WALL, WALL, PEG, PEG, PEG, WALL, WALL});
-        board.push_back({PEG, PEG, PEG, PEG, PEG, PEG, PEG});
-        board.push_back({PEG, PEG, PEG, FREE, PEG, PEG, PEG});
-        board.push_back({PEG, PEG, PEG, PEG, PEG, PEG, PEG});
-        board.push_back({WALL, WALL, PEG, PEG, PEG, WALL, WALL});
-        board.push_back({WALL, WALL, PEG, PEG, PEG, WALL, WALL});
+        return i;
     }
+#endif
 };
+#define NO_PARENT UINT32_MAX
+#define NO_JUMP UINT8_MAX
+
 /*
- * Nodes consist of a board state representation, a parent and
- * a last deleted peg index for frontier ordering for the first 3 methods.
+ * Nodes consist of a board state representation, the arena index of the
+ * parent, the applied jump and a last deleted peg index for frontier
+ * ordering for the first 3 methods. The cost is the number of moves of
+ * the path, a move being a chain of jumps made by the same peg, which is
+ * used by A* and IDA*. The weight is the heuristic weight of the board,
+ * it is updated from the parent with the three holes of the applied jump
+ * instead of rescanning the board. A node is 24 bytes and it is copied by value,
+ * so the frontiers do not need any reference counting.
  */
 class Node
 {
 public:
-    shared_ptr<Node> parent;
-    vector<vector<int>> board;
-    pair<int, int> lastDeletedPegIndex = {0, 0};
+    Bitboard board = 0;
+    uint32_t parent = NO_PARENT;
+    uint8_t jump = NO_JUMP;
+    uint8_t lastDeletedPegIndex = 0;
     // The initial board has only one free block so its score will be 1.
-    double score = 1;
-    Node(vector<vector<int>> board)
+    uint8_t score = 1;
+    uint8_t cost = 0;
+    int16_t weight = 0;
+    Node() {}
+    Node(Bitboard board)
     {
         this->board = board;
     }
 };
 
 /*
- * NodeSelection class determines how
- * the nodes are selected from the frontier.
- * This can be numbered order, random or heuristic.
+ * NodeArena keeps a small record for every expanded node instead of its
+ * board. A board on the path to a node is rebuilt by replaying the jumps
+ * of the records from the initial board. Stack based searches only need
+ * the records of the current path, so they rewind the arena to the parent
+ * of every popped node and the arena never grows beyond the search depth.
  */
-class NodeSelection
+struct NodeRecord
 {
-public:
-    virtual vector<shared_ptr<Node>> select(vector<shared_ptr<Node>> &nodes) = 0;
+    uint32_t parent;
+    uint8_t jump;
+    uint8_t score;
 };
 
-class IndexFirst : public NodeSelection
+/*
+ * The records are allocated in fixed size chunks, so a growing arena
+ * never copies its records and its memory grows one chunk at a time.
+ */
+class NodeArena
 {
-    vector<shared_ptr<Node>> select(vector<shared_ptr<Node>> &nodes)
+    static const int chunkBits = 16;
+    static const size_t chunkSize = size_t(1) << chunkBits;
+    vector<unique_ptr<NodeRecord[]>> chunks;
+    size_t numberOfRecords = 0;
+
+public:
+    uint32_t add(Node &node)
     {
-        stable_sort(nodes.begin(), nodes.end(),
-                    [](const auto &l, const auto &r)
-                    {
-                        if (l->lastDeletedPegIndex.first == r->lastDeletedPegIndex.first)
-                        {
-                            return l->lastDeletedPegIndex.second > r->lastDeletedPegIndex.second;
-                        }
-                        else
-                        {
-                            return l->lastDeletedPegIndex.first > r->lastDeletedPegIndex.first;
-                        }
-                    });
-        return nodes;
+        return add({node.parent, node.jump, node.score});
     }
-};
 
-class Random : public NodeSelection
-{
-    vector<shared_ptr<Node>> select(vector<shared_ptr<Node>> &nodes)
+    uint32_t add(NodeRecord record)
     {
-        shuffle(nodes.begin(), nodes.end(), default_random_engine{random_device{}()});
-        return nodes;
+        if (numberOfRecords == chunks.size() * chunkSize)
+            chunks.push_back(make_unique<NodeRecord[]>(chunkSize));
+        (*this)[numberOfRecords] = record;
+        return numberOfRecords++;
     }
-};
 
-/*
- * Our Heuristic class handles the frontier selection for
- * the DFS with a Node Selection Heuristic method.
- * The lower heuristic score is better chance to be selected in the frontier.
- * All the heuristic scores of the frontier nodes are then sorted and some of them
- * are to be neglected to prune the tree search space. Below, other details are explained:
- */
-class Heuristic : public NodeSelection
-{
-    int calculateBoardHeuristic(shared_ptr<Node> &node)
+    NodeRecord &operator[](size_t index)
     {
-        int heuristic = 0;
+        return chunks[index >> chunkBits][index & (chunkSize - 1)];
+    }
 
-        for (int i = 0; i < node->board.size(); i++)
-        {
-            for (int j = 0; j < node->board[i].size(); j++)
-            {
-                if (node->board[i][j] == PEG)
-                {
-                    /*
-                     * Calculating the squared oclidean distances of the pegs
-                     * to the center (closer is better):
-                     */
-                    heuristic += pow(i - 3, 2) + pow(j - 3, 2);
-
-                    /*
-                     * The pegs in the corners should be avoided.Because
-                     * the pegs in the corners cannot be removed easily.
-                     */
-                    if (i == 0 && j == 3 || i == 0 && j == 5 ||
-                        i == 3 && j == 0 || i == 5 && j == 0 ||
-                        i == 3 && j == 8 || i == 5 && j == 8 ||
-                        i == 8 && j == 3 || i == 8 && j == 5)
-                    {
-                        heuristic += 2;
-                    }
+    // Removes the records after the given size, the first chunk is kept:
+    void rewind(size_t size)
+    {
+        if (size >= numberOfRecords)
+            return;
+        numberOfRecords = size;
+        chunks.resize(max(size_t(1), (size + chunkSize - 1) >> chunkBits));
+    }
 
-                    /*
-                     * Checking if the blocks around center have a peg or not.
-                     * This helps to get to the optimal solution by checking if
-                     * any of the center blocks have one peg to handle the final move
-                     * towards to the center block.
-                     */
-                    if (i == 3 && j == 3 || i == 1 && j == 3 ||
-                        i == 3 && j == 1 || i == 3 && j == 5 ||
-                        i == 5 && j == 3)
-                    {
-                        heuristic -= 10;
-                    }
-                }
-            }
-        }
+    void clear()
+    {
+        rewind(0);
+    }
 
-        // Adding the score of the node to the heuristic:
-        heuristic -= node->score;
-        return heuristic;
+    size_t size()
+    {
+        return numberOfRecords;
     }
 
-    /*
-     * We select the nodes with higher numbers of emtpy blocks.
-     * So, we create a priority queue for every move state in every depth:
-     */
-    vector<shared_ptr<Node>> select(vector<shared_ptr<Node>> &nodes)
+    size_t bytes()
     {
-        vector<pair<int, shared_ptr<Node>>> prioritizedMoves;
-        vector<shared_ptr<Node>> res;
+        return chunks.size() * chunkSize * sizeof(NodeRecord);
+    }
 
-        for (auto node : nodes)
+    // Returns the jumps from the initial board to the node in the given index:
+    vector<uint8_t> path(uint32_t index)
+    {
+        vector<uint8_t> jumps;
+        while (index != NO_PARENT && (*this)[index].jump != NO_JUMP)
         {
-            auto score = calculateBoardHeuristic(node);
-            prioritizedMoves.push_back(make_pair(score, node));
+            jumps.push_back((*this)[index].jump);
+            index = (*this)[index].parent;
         }
-        // To reverse the array later, we sort the array increasingly:
-        sort(prioritizedMoves.begin(), prioritizedMoves.end(),
-             [](const auto &l, const auto &r)
-             {
-                 return l.first < r.first;
-             });
+        reverse(jumps.begin(), jumps.end());
+        return jumps;
+    }
+};
 
-        /* We do not include the unpromising boards to the frontier by
-         * neglecting the lower half of the acquired moves:
-         * This provides cutting the search space by half for every new move search.
-         */
-        int counter = 0;
-        while (prioritizedMoves.empty() == false)
+/*
+ * Children is the buffer that an expanded node writes its children to.
+ * A board has at most one child for every jump, so a search reuses one
+ * buffer for all of its nodes and never allocates it again.
+ */
+class Children
+{
+public:
+    Node nodes[MAX_NUMBER_OF_JUMPS];
+    int size = 0;
+
+    void clear()
+    {
+        size = 0;
+    }
+    void push(Node &node)
+    {
+        nodes[size++] = node;
+    }
+    Node *begin()
+    {
+        return nodes;
+    }
+    Node *end()
+    {
+        return nodes + size;
+    }
+    // Removes the first count children and keeps the order of the others:
+    void removeFirst(int count)
+    {
+        copy(nodes + count, nodes + size, nodes);
+        size -= count;
+    }
+};
+
+/*
+ * Orders the children by increasing keys in place with an odd-even
+ * transposition network. It only swaps the neighbours whose keys are out
+ * of order, so the children with equal keys keep their index order like
+ * a stable sort. A node has a few dozens of children at most, where the
+ * network is cheaper than a general sort.
+ */
+template <typename Key>
+void sortChildren(Children &children, Key key)
+{
+    for (int round = 0; round < children.size; round++)
+    {
+        for (int i = round & 1; i + 1 < children.size; i += 2)
+        {
+            if (key(children.nodes[i + 1]) < key(children.nodes[i]))
+                swap(children.nodes[i], children.nodes[i + 1]);
+        }
+    }
+}
+
+/*
+ * NodeSelection class determines how
+ * the nodes are selected from the frontier.
+ * This can be numbered order, random or heuristic.
+ * It orders or removes the children in their buffer.
+ */
+class NodeSelection
+{
+public:
+    virtual void select(Children &children) = 0;
+};
+
+class IndexFirst final : public NodeSelection
+{
+public:
+    void select(Children &children)
+    {
+        sortChildren(children, [](const Node &node)
+                     { return -node.lastDeletedPegIndex; });
+    }
+};
+
+/*
+ * SplitMix64 is a small and fast generator with a 64 bit state, so every
+ * worker can own a stream that is fully defined by its seed:
+ */
+class FastRandom
+{
+    uint64_t state;
+
+public:
+    FastRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // A number in [0, bound), by a multiplication instead of a division:
+    uint32_t below(uint32_t bound)
+    {
+        return static_cast<uint32_t>((next() >> 32) * bound >> 32);
+    }
+};
+
+/*
+ * The random engine is seeded once, so a run can be repeated with its seed:
+ */
+class Random final : public NodeSelection
+{
+    FastRandom engine;
+
+public:
+    Random(unsigned seed) : engine(seed) {}
+
+    void select(Children &children)
+    {
+        for (int i = children.size; i > 1; i--)
+        {
+            swap(children.nodes[i - 1], children.nodes[engine.below(i)]);
+        }
+    }
+};
+
+/*
+ * Our Heuristic class handles the frontier selection for
+ * the DFS with a Node Selection Heuristic method.
+ * The lower heuristic score is better chance to be selected in the frontier.
+ * All the heuristic scores of the frontier nodes are then sorted and some of them
+ * are to be neglected to prune the tree search space. Below, other details are explained:
+ */
+class Heuristic final : public NodeSelection
+{
+    /*
+     * The weight of the board is kept up to date by every jump
+     * (see pegWeight), so the heuristic of a node is O(1):
+     */
+    int calculateBoardHeuristic(Node &node)
+    {
+        // Adding the score of the node to the heuristic:
+        return node.weight - node.score;
+    }
+
+public:
+    /*
+     * We select the nodes with higher numbers of emtpy blocks.
+     * So, we order the moves by decreasing heuristic, the best move is the
+     * last one and it is popped first from the stack:
+     */
+    void select(Children &children)
+    {
+        // Among the moves with equal heuristics, the last found move is the worst one:
+        reverse(children.begin(), children.end());
+        sortChildren(children, [this](Node &node)
+                     { return -calculateBoardHeuristic(node); });
+
+        /* We do not include the unpromising boards to the frontier by
+         * neglecting the lower half of the acquired moves:
+         * This provides cutting the search space by half for every new move search.
+         * The half is taken from the moves that are left after every neglected move,
+         * so about a third of the moves are neglected:
+         */
+        int neglected = 0;
+        while (neglected + 1 <= (children.size - neglected) / 2)
+        {
+            neglected++;
+        }
+        children.removeFirst(neglected);
+    }
+};
+
+enum SelectionType
+{
+    INDEX_FIRST,
+    RANDOM,
+    HEURISTIC
+};
+
+shared_ptr<NodeSelection> createSelection(SelectionType type, unsigned seed)
+{
+    if (type == RANDOM)
+        return make_shared<Random>(seed);
+    if (type == HEURISTIC)
+        return make_shared<Heuristic>();
+    return make_shared<IndexFirst>();
+}
+
+/*
+ * Frontier class is a base class for both
+ * Queue and Stack which is used by DFS and BFS
+ * algorithms. Queue and Stack classes are wrappers
+ * around stl queue and stack classes. The frontiers are final, so
+ * the search loop that is compiled for one of them calls it directly.
+ */
+class Frontier
+{
+public:
+    virtual bool empty() = 0;
+    virtual size_t size() = 0;
+    virtual void push(Node node) = 0;
+    virtual Node pop_return() = 0;
+    // The last pushed node is popped first:
+    virtual bool isLastInFirstOut() = 0;
+    // Number of the bytes that the frontier holds in the memory:
+    virtual size_t bytes() = 0;
+    // Number of the nodes in the memory, the others are spilled to the disk:
+    virtual size_t memorySize()
+    {
+        return size();
+    }
+    /*
+     * Removes at most count nodes with the worst scores to free memory
+     * and returns the number of the removed nodes:
+     */
+    virtual size_t prune(size_t)
+    {
+        return 0;
+    }
+    /*
+     * Copies the nodes in their push order, so pushing them again restores
+     * the frontier. Returns false if the frontier cannot be copied:
+     */
+    virtual bool snapshot(vector<Node> &)
+    {
+        return false;
+    }
+};
+
+/*
+ * The standard deque stores the nodes in blocks of 512 bytes
+ * and keeps a pointer to every block:
+ */
+size_t nodeDequeBytes(size_t size)
+{
+    size_t blocks = size * sizeof(Node) / 512 + 1;
+    return blocks * (512 + sizeof(void *));
+}
+
+/*
+ * A full vector doubles its capacity on the next push, so it is counted
+ * with the doubled capacity and the governor sees the growth before the
+ * vector takes the memory:
+ */
+size_t nodeVectorBytes(vector<Node> &nodes)
+{
+    size_t capacity = nodes.capacity();
+    if (nodes.size() == capacity)
+        capacity = max<size_t>(2 * capacity, 1);
+    return capacity * sizeof(Node);
+}
+
+/*
+ * Removes count nodes with the lowest scores from the nodes and keeps the
+ * order of the others. The scores are small, so a histogram of them gives
+ * the score below which all nodes are removed:
+ */
+template <typename Nodes>
+size_t pruneLowestScores(Nodes &nodes, size_t count)
+{
+    count = min(count, nodes.size());
+    size_t counts[256] = {0};
+    for (auto &node : nodes)
+    {
+        counts[node.score]++;
+    }
+    int cutoff = 0;
+    size_t below = 0;
+    while (below + counts[cutoff] <= count && cutoff < 255)
+    {
+        below += counts[cutoff++];
+    }
+    // All of the nodes below the cutoff and some of the nodes at the cutoff are removed:
+    size_t atCutoff = count - below;
+    size_t kept = 0;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].score < cutoff)
+            continue;
+        if (nodes[i].score == cutoff && atCutoff > 0)
+        {
+            atCutoff--;
+            continue;
+        }
+        nodes[kept++] = nodes[i];
+    }
+    nodes.resize(kept);
+    nodes.shrink_to_fit();
+    return count;
+}
+
+/*
+ * The stack keeps its capacity when it shrinks, so a depth-first search
+ * stops allocating once its stack has reached its deepest size.
+ */
+class Stack final : public Frontier
+{
+    vector<Node> s;
+
+public:
+    bool empty()
+    {
+        return s.empty();
+    }
+    size_t size()
+    {
+        return s.size();
+    }
+    void push(Node node)
+    {
+        s.push_back(node);
+    }
+    Node pop_return()
+    {
+        auto ret = s.back();
+        s.pop_back();
+        return ret;
+    }
+    bool isLastInFirstOut()
+    {
+        return true;
+    }
+    size_t bytes()
+    {
+        return nodeVectorBytes(s);
+    }
+    size_t prune(size_t count)
+    {
+        return pruneLowestScores(s, count);
+    }
+    bool snapshot(vector<Node> &nodes)
+    {
+        nodes.assign(s.begin(), s.end());
+        return true;
+    }
+};
+
+class Queue final : public Frontier
+{
+    deque<Node> q;
+
+public:
+    bool empty()
+    {
+        return q.empty();
+    }
+    size_t size()
+    {
+        return q.size();
+    }
+    void push(Node node)
+    {
+        q.push_back(node);
+    }
+    Node pop_return()
+    {
+        auto ret = q.front();
+        q.pop_front();
+        return ret;
+    }
+    bool isLastInFirstOut()
+    {
+        return false;
+    }
+    size_t bytes()
+    {
+        return nodeDequeBytes(q.size());
+    }
+    size_t prune(size_t count)
+    {
+        return pruneLowestScores(q, count);
+    }
+    bool snapshot(vector<Node> &nodes)
+    {
+        nodes.assign(q.begin(), q.end());
+        return true;
+    }
+};
+
+/*
+ * SpillStorage writes blocks of nodes to numbered segment files in a
+ * directory and reads them back. A segment is the raw sequence of the
+ * nodes, written and read with one buffered call.
+ */
+class SpillStorage
+{
+    string directory;
+    string prefix;
+    int nextSegment = 0;
+
+public:
+    long numberOfSpilledNodes = 0;
+
+    SpillStorage(string directory)
+    {
+        static atomic<int> counter{0};
+        this->directory = directory;
+        prefix = "solotest_" + to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                 "_" + to_string(counter++) + "_";
+        // A directory that cannot be created fails the writes, so the nodes stay in the memory:
+        error_code error;
+        filesystem::create_directories(directory, error);
+    }
+
+    string segmentPath(int segment)
+    {
+        return (filesystem::path(directory) / (prefix + to_string(segment) + ".bin")).string();
+    }
+
+    // Returns the number of the written segment, or -1 if the disk write fails:
+    int write(vector<Node> &nodes)
+    {
+        int segment = nextSegment;
+        FILE *file = fopen(segmentPath(segment).c_str(), "wb");
+        if (file == nullptr)
+            return -1;
+        auto written = fwrite(nodes.data(), sizeof(Node), nodes.size(), file);
+        fclose(file);
+        if (written != nodes.size())
+        {
+            remove(segment);
+            return -1;
+        }
+        nextSegment++;
+        numberOfSpilledNodes += nodes.size();
+        return segment;
+    }
+
+    // Reads the segment and deletes its file:
+    void read(int segment, vector<Node> &nodes)
+    {
+        auto path = segmentPath(segment);
+        error_code error;
+        auto size = filesystem::file_size(path, error);
+        nodes.resize(error ? 0 : size / sizeof(Node));
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file != nullptr)
+        {
+            nodes.resize(fread(nodes.data(), sizeof(Node), nodes.size(), file));
+            fclose(file);
+        }
+        remove(segment);
+    }
+
+    void remove(int segment)
+    {
+        error_code error;
+        filesystem::remove(segmentPath(segment), error);
+    }
+};
+
+/*
+ * SpillingQueue is a queue that keeps at most about SPILL_MEMORY_NODES
+ * nodes in the memory. The oldest nodes are in the head, the newest ones
+ * are in the tail, and the full tail blocks in between are on the disk.
+ * The blocks are read back in order when the head becomes empty.
+ */
+class SpillingQueue final : public Frontier
+{
+    SpillStorage storage;
+    deque<Node> head;
+    vector<Node> tail;
+    deque<int> segments;
+    size_t numberOfNodes = 0;
+
+public:
+    SpillingQueue(string directory) : storage(directory) {}
+
+    ~SpillingQueue()
+    {
+        for (auto segment : segments)
+        {
+            storage.remove(segment);
+        }
+    }
+
+    bool empty()
+    {
+        return numberOfNodes == 0;
+    }
+    size_t size()
+    {
+        return numberOfNodes;
+    }
+    size_t bytes()
+    {
+        return nodeDequeBytes(head.size()) + nodeVectorBytes(tail);
+    }
+    size_t memorySize()
+    {
+        return head.size() + tail.size();
+    }
+    long numberOfSpilledNodes()
+    {
+        return storage.numberOfSpilledNodes;
+    }
+    void push(Node node)
+    {
+        tail.push_back(node);
+        numberOfNodes++;
+        if (tail.size() < SPILL_SEGMENT_NODES)
+            return;
+        int segment = -1;
+        if (segments.empty() == false || head.size() + tail.size() > SPILL_MEMORY_NODES)
+            segment = storage.write(tail);
+        if (segment == -1)
+        {
+            // Nothing is on the disk or it cannot be written, so the tail stays in the memory:
+            if (segments.empty() == false)
+                return;
+            head.insert(head.end(), tail.begin(), tail.end());
+        }
+        else
+        {
+            segments.push_back(segment);
+        }
+        tail.clear();
+    }
+    Node pop_return()
+    {
+        if (head.empty() == true)
+        {
+            if (segments.empty() == false)
+            {
+                vector<Node> block;
+                storage.read(segments.front(), block);
+                segments.pop_front();
+                head.insert(head.end(), block.begin(), block.end());
+            }
+            else
+            {
+                head.insert(head.end(), tail.begin(), tail.end());
+                tail.clear();
+            }
+        }
+        auto ret = head.front();
+        head.pop_front();
+        numberOfNodes--;
+        return ret;
+    }
+    bool isLastInFirstOut()
+    {
+        return false;
+    }
+};
+
+/*
+ * SpillingStack is a stack that moves its bottom SPILL_SEGMENT_NODES
+ * nodes to the disk when it has more than SPILL_MEMORY_NODES nodes in the
+ * memory. The last written block is read back when the memory part of
+ * the stack becomes empty, so the order of the nodes does not change.
+ */
+class SpillingStack final : public Frontier
+{
+    SpillStorage storage;
+    deque<Node> s;
+    vector<int> segments;
+    size_t numberOfNodes = 0;
+
+public:
+    SpillingStack(string directory) : storage(directory) {}
+
+    ~SpillingStack()
+    {
+        for (auto segment : segments)
+        {
+            storage.remove(segment);
+        }
+    }
+
+    bool empty()
+    {
+        return numberOfNodes == 0;
+    }
+    size_t size()
+    {
+        return numberOfNodes;
+    }
+    size_t bytes()
+    {
+        return nodeDequeBytes(s.size());
+    }
+    size_t memorySize()
+    {
+        return s.size();
+    }
+    long numberOfSpilledNodes()
+    {
+        return storage.numberOfSpilledNodes;
+    }
+    void push(Node node)
+    {
+        s.push_back(node);
+        numberOfNodes++;
+        if (s.size() <= SPILL_MEMORY_NODES)
+            return;
+        vector<Node> block(s.begin(), s.begin() + SPILL_SEGMENT_NODES);
+        int segment = storage.write(block);
+        if (segment == -1)
+            return;
+        segments.push_back(segment);
+        s.erase(s.begin(), s.begin() + SPILL_SEGMENT_NODES);
+    }
+    Node pop_return()
+    {
+        if (s.empty() == true)
+        {
+            vector<Node> block;
+            storage.read(segments.back(), block);
+            segments.pop_back();
+            s.insert(s.end(), block.begin(), block.end());
+        }
+        auto ret = s.back();
+        s.pop_back();
+        numberOfNodes--;
+        return ret;
+    }
+    bool isLastInFirstOut()
+    {
+        return true;
+    }
+};
+
+/*
+ * Checkpoint is a copy of the state of a frontier search: the frontier,
+ * the arena records that the paths of its nodes refer to, the visited
+ * boards, the best node and the counters. The file is the header and the
+ * fields in the order below, every vector as its size and its raw items.
+ */
+struct Checkpoint
+{
+    // A checkpoint is only resumed by the same search of the same problem:
+    string board;
+    string method;
+    Bitboard start = 0;
+    Bitboard goal = 0;
+    int32_t depthLimit = 0;
+    uint32_t pruningRules = 0;
+    int32_t memoryPolicy = 0;
+    bool isLastInFirstOut = true;
+    bool isSwitchedToDFS = false;
+    uint64_t fallbackArenaSize = 0;
+    int32_t maxScore = 0;
+    int64_t numberOfExpandedNodes = 0;
+    int32_t maxNumberOfStoredNodes = 0;
+    int64_t probes = 0;
+    int64_t hits = 0;
+    int64_t replacements = 0;
+    Node bestNode;
+    vector<uint8_t> bestPath;
+    vector<Node> frontier;
+    vector<Node> fallbackStack;
+    vector<NodeRecord> arena;
+    vector<Bitboard> visited;
+};
+
+const char CHECKPOINT_MAGIC[8] = {'S', 'O', 'L', 'O', 'C', 'K', 'P', '3'};
+
+class CheckpointFile
+{
+    FILE *file;
+    bool isGood = true;
+
+    void data(void *items, size_t size, bool isWriting)
+    {
+        if (isGood == true && size > 0)
+            isGood = (isWriting ? fwrite(items, 1, size, file) : fread(items, 1, size, file)) == size;
+    }
+
+    template <typename T>
+    void value(T &item, bool isWriting)
+    {
+        data(&item, sizeof(T), isWriting);
+    }
+
+    template <typename T>
+    void items(vector<T> &items, bool isWriting)
+    {
+        uint64_t size = items.size();
+        value(size, isWriting);
+        if (isWriting == false && isGood == true)
+            items.resize(size);
+        data(items.data(), size * sizeof(T), isWriting);
+    }
+
+    // The same field list is used to write and to read the file:
+    bool transfer(Checkpoint &c, bool isWriting)
+    {
+        char magic[8];
+        copy(begin(CHECKPOINT_MAGIC), end(CHECKPOINT_MAGIC), magic);
+        data(magic, sizeof(magic), isWriting);
+        if (equal(begin(magic), end(magic), begin(CHECKPOINT_MAGIC)) == false)
+            return false;
+        vector<char> name(c.board.begin(), c.board.end());
+        items(name, isWriting);
+        c.board.assign(name.begin(), name.end());
+        vector<char> method(c.method.begin(), c.method.end());
+        items(method, isWriting);
+        c.method.assign(method.begin(), method.end());
+        value(c.start, isWriting);
+        value(c.goal, isWriting);
+        value(c.depthLimit, isWriting);
+        value(c.pruningRules, isWriting);
+        value(c.memoryPolicy, isWriting);
+        value(c.isLastInFirstOut, isWriting);
+        value(c.isSwitchedToDFS, isWriting);
+        value(c.fallbackArenaSize, isWriting);
+        value(c.maxScore, isWriting);
+        value(c.numberOfExpandedNodes, isWriting);
+        value(c.maxNumberOfStoredNodes, isWriting);
+        value(c.probes, isWriting);
+        value(c.hits, isWriting);
+        value(c.replacements, isWriting);
+        value(c.bestNode, isWriting);
+        items(c.bestPath, isWriting);
+        items(c.frontier, isWriting);
+        items(c.fallbackStack, isWriting);
+        items(c.arena, isWriting);
+        items(c.visited, isWriting);
+        return isGood;
+    }
+
+public:
+    /*
+     * The file is written next to the old one and renamed over it, so a
+     * killed process always leaves a complete checkpoint behind:
+     */
+    static bool write(Checkpoint &checkpoint, string path)
+    {
+        string temporaryPath = path + ".tmp";
+        CheckpointFile out;
+        out.file = fopen(temporaryPath.c_str(), "wb");
+        if (out.file == nullptr)
+            return false;
+        bool written = out.transfer(checkpoint, true);
+        written = fclose(out.file) == 0 && written;
+        error_code error;
+        if (written == true)
+            filesystem::rename(temporaryPath, path, error);
+        return written == true && !error;
+    }
+
+    static bool read(Checkpoint &checkpoint, string path)
+    {
+        CheckpointFile in;
+        in.file = fopen(path.c_str(), "rb");
+        if (in.file == nullptr)
+            return false;
+        bool read = in.transfer(checkpoint, false);
+        fclose(in.file);
+        return read;
+    }
+};
+
+/*
+ * CheckpointWriter writes the checkpoints with a background thread, so
+ * the search only stops to copy its state. A checkpoint is skipped if
+ * the previous one is still being written.
+ */
+class CheckpointWriter
+{
+    thread writer;
+    atomic<bool> isWriting{false};
+    // The time of the next checkpoint, the watchdog raises the due flag after it:
+    atomic<std::chrono::steady_clock::rep> next{0};
+    atomic<bool> due{false};
+
+public:
+    string path;
+    double interval = CHECKPOINT_INTERVAL_SECONDS;
+    atomic<int> numberOfCheckpoints{0};
+    atomic<int> numberOfFailedCheckpoints{0};
+
+    ~CheckpointWriter()
+    {
+        join();
+    }
+
+    void start()
+    {
+        due = false;
+        next = (std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<long>(interval * 1000)))
+                   .time_since_epoch()
+                   .count();
+    }
+
+    // Called by the watchdog, so the search loop does not read the clock:
+    void tick(std::chrono::steady_clock::time_point now)
+    {
+        if (path.empty() == false && now.time_since_epoch().count() >= next.load())
+            due = true;
+    }
+
+    bool isDue()
+    {
+        return due.load(memory_order_relaxed) == true && isWriting.load(memory_order_relaxed) == false;
+    }
+
+    void write(Checkpoint &&checkpoint)
+    {
+        join();
+        isWriting = true;
+        writer = thread([this, c = move(checkpoint)]() mutable
+                        {
+                            if (CheckpointFile::write(c, path) == true)
+                                numberOfCheckpoints++;
+                            else
+                                numberOfFailedCheckpoints++;
+                            isWriting = false; });
+        start();
+    }
+
+    void join()
+    {
+        if (writer.joinable() == true)
+            writer.join();
+    }
+};
+
+/*
+ * MoveCost is the cost model of A* and IDA*. The cost of a path is its
+ * number of moves (see Node), so the jumps of every solution cost the
+ * same and the search looks for the solution with the fewest moves.
+ * The estimate counts the pegs in the corner holes, the holes that no
+ * jump can pass over. A peg in a corner can only leave it by starting a
+ * move of its own, and one move empties at most one corner, so it never
+ * overestimates the remaining moves. The last moved peg can continue
+ * without a new move, so it is not counted if it is in a corner.
+ */
+class MoveCost
+{
+    SoloTest *st;
+
+public:
+    Bitboard corners;
+
+    MoveCost(SoloTest &st)
+    {
+        this->st = &st;
+        Bitboard jumpedHoles = 0;
+        for (auto &jump : st.jumps)
+        {
+            jumpedHoles |= cellMask(jump.over);
+        }
+        // The peg in the goal hole does not need to move:
+        corners = st.holes & ~jumpedHoles & ~st.goal;
+    }
+
+    int estimate(Node &node)
+    {
+        int moves = countPegs(node.board & corners);
+        if (node.jump != NO_JUMP && (corners & cellMask(st->jumps[node.jump].to)) != 0)
+            moves--;
+        return moves;
+    }
+
+    int total(Node &node)
+    {
+        return node.cost + estimate(node);
+    }
+};
+
+/*
+ * BucketQueue is the open list of A*. The f-values are small integers,
+ * so there is a bucket for each of them and the push and pop operations
+ * take constant time. Nodes with equal f-values are popped in the last
+ * in first out order, which prefers the deeper nodes. The buckets are
+ * deques, so a bucket grows and shrinks by blocks and never reallocates
+ * all of its nodes at once.
+ */
+class BucketQueue final : public Frontier
+{
+    MoveCost &cost;
+    vector<deque<Node>> buckets;
+    size_t numberOfNodes = 0;
+    int minimum = NUMBER_OF_BUCKETS;
+
+public:
+    BucketQueue(MoveCost &cost) : cost(cost), buckets(NUMBER_OF_BUCKETS) {}
+
+    bool empty()
+    {
+        return numberOfNodes == 0;
+    }
+    size_t size()
+    {
+        return numberOfNodes;
+    }
+    void push(Node node)
+    {
+        int f = min(cost.total(node), NUMBER_OF_BUCKETS - 1);
+        buckets[f].push_back(node);
+        minimum = min(minimum, f);
+        numberOfNodes++;
+    }
+    Node pop_return()
+    {
+        while (buckets[minimum].empty() == true)
+        {
+            minimum++;
+        }
+        auto ret = buckets[minimum].back();
+        buckets[minimum].pop_back();
+        numberOfNodes--;
+        return ret;
+    }
+    bool isLastInFirstOut()
+    {
+        return false;
+    }
+    size_t bytes()
+    {
+        size_t total = 0;
+        for (auto &bucket : buckets)
+        {
+            total += nodeDequeBytes(bucket.size());
+        }
+        return total;
+    }
+    /*
+     * The nodes with the highest f-values are the worst ones. They are
+     * removed from the back of the buckets, which frees their blocks:
+     */
+    size_t prune(size_t count)
+    {
+        size_t removed = 0;
+        for (int f = NUMBER_OF_BUCKETS - 1; f >= 0 && removed < count; f--)
+        {
+            auto &bucket = buckets[f];
+            size_t n = min(bucket.size(), count - removed);
+            bucket.erase(bucket.end() - n, bucket.end());
+            bucket.shrink_to_fit();
+            removed += n;
+        }
+        numberOfNodes -= removed;
+        return removed;
+    }
+};
+
+/*
+ * WorkStealingStack is the stack of a parallel DFS worker. The owner
+ * pushes and pops at the top and the other workers steal the oldest
+ * nodes from the bottom, since they have the biggest subtrees.
+ * The owner holds the lock while it changes the stack or its arena.
+ */
+class WorkStealingStack
+{
+    deque<Node> s;
+
+public:
+    mutex lock;
+    // The size can be read by the other workers without the lock:
+    atomic<size_t> sharedSize{0};
+
+    bool empty()
+    {
+        return s.empty();
+    }
+    size_t size()
+    {
+        return s.size();
+    }
+    void push(Node node)
+    {
+        s.push_back(node);
+        sharedSize.store(s.size(), memory_order_relaxed);
+    }
+    Node pop_return()
+    {
+        auto ret = s.back();
+        s.pop_back();
+        sharedSize.store(s.size(), memory_order_relaxed);
+        return ret;
+    }
+    Node steal()
+    {
+        auto ret = s.front();
+        s.pop_front();
+        sharedSize.store(s.size(), memory_order_relaxed);
+        return ret;
+    }
+};
+
+/*
+ * Symmetry class maps a board to one representative of its rotations
+ * and reflections. Symmetric boards have the same subtrees when the
+ * symmetry keeps the goal hole in its place, so the search only needs
+ * to visit one of them. The symmetries of a board come from its geometry.
+ * A symmetry is applied with one table lookup per byte of the bitboard.
+ */
+class Symmetry
+{
+    static const int maxBytes = (MAX_NUMBER_OF_HOLES + 7) / 8;
+    Bitboard tables[MAX_NUMBER_OF_SYMMETRIES][maxBytes][256];
+    int bytes = 0;
+    int numberOfSymmetries = 0;
+
+public:
+    void create(SoloTest &st)
+    {
+        create(*st.geometry, st.geometry->symmetries, st.geometry->numberOfSymmetries);
+    }
+
+    // The tables of the given symmetries, the first one must be the identity:
+    void create(const Geometry &geometry, const int (*symmetries)[MAX_NUMBER_OF_HOLES], int numberOfSymmetries)
+    {
+        bytes = (geometry.numberOfHoles + 7) / 8;
+        this->numberOfSymmetries = numberOfSymmetries;
+        for (int symmetry = 0; symmetry < numberOfSymmetries; symmetry++)
+        {
+            for (int byte = 0; byte < bytes; byte++)
+            {
+                for (int value = 0; value < 256; value++)
+                {
+                    Bitboard transformed = 0;
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        int hole = byte * 8 + bit;
+                        if ((value & (1 << bit)) == 0 || hole >= geometry.numberOfHoles)
+                            continue;
+                        transformed |= cellMask(symmetries[symmetry][hole]);
+                    }
+                    tables[symmetry][byte][value] = transformed;
+                }
+            }
+        }
+    }
+
+    Bitboard transform(int symmetry, Bitboard board)
+    {
+        Bitboard transformed = 0;
+        for (int byte = 0; byte < bytes; byte++)
+        {
+            transformed |= tables[symmetry][byte][(board >> (byte * 8)) & 0xFF];
+        }
+        return transformed;
+    }
+
+    /*
+     * The number of the distinct boards among the symmetric boards, which is
+     * the number of the symmetries over the number of them that keep the board:
+     */
+    int orbitSize(Bitboard board)
+    {
+        int fixed = 1;
+        for (int symmetry = 1; symmetry < numberOfSymmetries; symmetry++)
+        {
+            fixed += transform(symmetry, board) == board;
+        }
+        return numberOfSymmetries / fixed;
+    }
+
+    // The smallest of the symmetric boards is the canonical board:
+    Bitboard canonical(Bitboard board)
+    {
+        Bitboard best = board;
+        for (int symmetry = 1; symmetry < numberOfSymmetries; symmetry++)
+        {
+            best = min(best, transform(symmetry, board));
+        }
+        return best;
+    }
+};
+
+/*
+ * The lookups of the duplicate boards. The layered searches find their
+ * duplicates by sorting and count them here without a table:
+ */
+struct TableCounters
+{
+    long probes = 0;
+    long hits = 0;
+    long replacements = 0;
+
+    double hitRate()
+    {
+        return probes == 0 ? 0 : 100.0 * hits / probes;
+    }
+};
+
+/*
+ * TranspositionTable remembers the canonical boards that are already
+ * visited. It has a fixed memory size and it is organized in buckets of
+ * 4 boards. When a bucket is full, the board with the fewest pegs is
+ * replaced since it has the smallest subtree to search again. So a lookup
+ * can miss an old board but it never reports a board that is not visited.
+ * The slots are relaxed atomics, so the parallel solvers can share a table.
+ */
+class TranspositionTable
+{
+    static const int bucketSize = 4;
+    unique_ptr<atomic<Bitboard>[]> slots;
+    size_t numberOfBuckets = 0;
+
+public:
+    TableCounters counters;
+
+    // A table of 0 megabytes has no slots until it is created:
+    TranspositionTable(size_t megabytes = TRANSPOSITION_TABLE_MB)
+    {
+        if (megabytes > 0)
+            create(megabytes);
+    }
+
+    void create(size_t megabytes)
+    {
+        numberOfBuckets = 1;
+        while (numberOfBuckets * 2 * bucketSize * sizeof(Bitboard) <= megabytes * 1024 * 1024)
+        {
+            numberOfBuckets *= 2;
+        }
+        slots.reset(new atomic<Bitboard>[numberOfBuckets * bucketSize]);
+        clear();
+    }
+
+    bool isCreated()
+    {
+        return slots != nullptr;
+    }
+
+    // An empty board is never searched, so 0 marks an empty slot:
+    void clear()
+    {
+        for (size_t i = 0; i < numberOfBuckets * bucketSize; i++)
+        {
+            slots[i].store(0, memory_order_relaxed);
+        }
+    }
+
+    /*
+     * Inserts the board to the table and returns true if it has already
+     * been in the table. It does not update the counters, so it is safe
+     * to call from many threads:
+     */
+    bool visit(Bitboard board, bool &replaced)
+    {
+        auto bucket = &slots[((board * 0x9E3779B97F4A7C15ULL) >> 20 & (numberOfBuckets - 1)) * bucketSize];
+        int victim = 0;
+        int victimPegs = MAX_NUMBER_OF_HOLES + 1;
+        for (int i = 0; i < bucketSize; i++)
+        {
+            auto slot = bucket[i].load(memory_order_relaxed);
+            if (slot == board)
+                return true;
+            if (slot == 0)
+            {
+                bucket[i].store(board, memory_order_relaxed);
+                return false;
+            }
+            if (countPegs(slot) < victimPegs)
+            {
+                victim = i;
+                victimPegs = countPegs(slot);
+            }
+        }
+        bucket[victim].store(board, memory_order_relaxed);
+        replaced = true;
+        return false;
+    }
+
+    bool contains(Bitboard board)
+    {
+        auto bucket = &slots[((board * 0x9E3779B97F4A7C15ULL) >> 20 & (numberOfBuckets - 1)) * bucketSize];
+        for (int i = 0; i < bucketSize; i++)
+        {
+            if (bucket[i].load(memory_order_relaxed) == board)
+                return true;
+        }
+        return false;
+    }
+
+    bool insert(Bitboard board)
+    {
+        bool replaced = false;
+        bool found = visit(board, replaced);
+        counters.probes++;
+        counters.hits += found;
+        counters.replacements += replaced;
+        return found;
+    }
+
+    // Only the used slots are copied, so the copy does not depend on the table size:
+    void snapshot(vector<Bitboard> &boards)
+    {
+        boards.clear();
+        for (size_t i = 0; i < numberOfBuckets * bucketSize; i++)
+        {
+            auto slot = slots[i].load(memory_order_relaxed);
+            if (slot != 0)
+                boards.push_back(slot);
+        }
+    }
+
+    size_t bytes()
+    {
+        return numberOfBuckets * bucketSize * sizeof(Bitboard);
+    }
+};
+
+/*
+ * BoardCache remembers the dead boards, from which the goal hole cannot be
+ * reached, and the solvable boards, which are on a found solution, so the
+ * jobs of a batch do not search the same subtrees again. A board and its
+ * goal are turned together by the symmetries of the whole board: the key
+ * is the smallest board among the symmetries that move the goal to the
+ * smallest hole of its orbit, so the symmetric jobs find the boards of
+ * each other. The goal is kept in the free high bits of the key.
+ */
+class BoardCache
+{
+    const Geometry *geometry = nullptr;
+    Symmetry symmetry;
+    TranspositionTable deadBoards;
+    TranspositionTable solvableBoards{PORTFOLIO_TABLE_MB};
+
+public:
+    BoardCache(const Geometry &geometry, size_t megabytes = TRANSPOSITION_TABLE_MB) : deadBoards(megabytes)
+    {
+        this->geometry = &geometry;
+        symmetry.create(geometry, geometry.boardSymmetries, geometry.numberOfBoardSymmetries);
+    }
+
+    Bitboard key(Bitboard board, int goalHole)
+    {
+        int goal = goalHole;
+        for (int k = 1; k < geometry->numberOfBoardSymmetries; k++)
+        {
+            goal = min(goal, geometry->boardSymmetries[k][goalHole]);
+        }
+        Bitboard best = ~Bitboard(0);
+        for (int k = 0; k < geometry->numberOfBoardSymmetries; k++)
+        {
+            if (geometry->boardSymmetries[k][goalHole] == goal)
+                best = min(best, symmetry.transform(k, board));
+        }
+        return best | Bitboard(goal + 1) << MAX_NUMBER_OF_HOLES;
+    }
+
+    // The functions below take the keys and are safe to call from many threads, like the tables:
+    bool isDead(Bitboard key)
+    {
+        return deadBoards.contains(key);
+    }
+
+    bool isSolvable(Bitboard key)
+    {
+        return solvableBoards.contains(key);
+    }
+
+    // Returns true if the key is a new board that did not replace another one:
+    bool addDead(Bitboard key)
+    {
+        bool replaced = false;
+        return deadBoards.visit(key, replaced) == false && replaced == false;
+    }
+
+    void addSolvable(Bitboard key)
+    {
+        bool replaced = false;
+        solvableBoards.visit(key, replaced);
+    }
+
+    size_t bytes()
+    {
+        return deadBoards.bytes() + solvableBoards.bytes();
+    }
+};
+
+/*
+ * The rules that discard the boards which can never reach the goal.
+ * Every pagoda function is a rule of its own, so their savings can be
+ * compared, and the isolated peg rule is the last one:
+ */
+enum PruningRule
+{
+    ODD_HOLES_PAGODA,
+    CORNER_PAGODA,
+    ISOLATED_PEG,
+    NUMBER_OF_PRUNING_RULES
+};
+
+/*
+ * A pagoda function gives every hole a weight such that no legal jump can
+ * increase the total weight of the pegs: w(to) <= w(from) + w(over).
+ * A board whose total is less than the total of the goal board can never
+ * be solved. The weights are -1, 0, 1 or 2, so a total is three masked
+ * popcounts.
+ */
+class Pruning
+{
+    struct Pagoda
+    {
+        Bitboard negative = 0;
+        Bitboard single = 0;
+        Bitboard twice = 0;
+        int goal = 0;
+        bool isValid = false;
+    };
+
+    /*
+     * The first pagoda only counts the pegs in the odd holes around the center,
+     * a jump to one of them always starts from another one. The second one was
+     * found by a local search over the weights on random games and validated,
+     * it makes the corner pegs expensive. No other pagoda with these weights
+     * pruned more than a few boards of the random games that these two keep.
+     * They are laid out on the English board, the other boards use them
+     * only if they are valid for their jumps.
+     */
+    static const int pagodaSize = 7;
+    static constexpr int pagodaWeights[CORNER_PAGODA + 1][pagodaSize][pagodaSize] = {
+        {{0, 0, 0, 0, 0, 0, 0},
+         {0, 0, 0, 1, 0, 0, 0},
+         {0, 0, 0, 0, 0, 0, 0},
+         {0, 1, 0, 1, 0, 1, 0},
+         {0, 0, 0, 0, 0, 0, 0},
+         {0, 0, 0, 1, 0, 0, 0},
+         {0, 0, 0, 0, 0, 0, 0}},
+        {{0, 0, -1, 0, -1, 0, 0},
+         {0, 0, 1, 1, 1, 0, 0},
+         {-1, 1, 0, 1, 0, 1, -1},
+         {0, 1, 1, 2, 1, 1, 0},
+         {-1, 1, 0, 1, 0, 1, -1},
+         {0, 0, 1, 1, 1, 0, 0},
+         {0, 0, -1, 0, -1, 0, 0}}};
+
+    Pagoda pagodas[CORNER_PAGODA + 1];
+    /*
+     * The holes within a distance of a hole, the hole itself is excluded.
+     * The distance is the number of steps between the neighbour holes,
+     * the holes next to each other on the line of a jump:
+     */
+    Bitboard balls[MAX_NUMBER_OF_HOLES][MAX_NUMBER_OF_HOLES];
+    int diameter = 0;
+
+    int value(Pagoda &pagoda, Bitboard board)
+    {
+        return countPegs(board & pagoda.single) + 2 * countPegs(board & pagoda.twice) -
+               countPegs(board & pagoda.negative);
+    }
+
+public:
+    // The counters are shared by the threads of the parallel searches:
+    atomic<long> numberOfPrunedNodes[NUMBER_OF_PRUNING_RULES];
+
+    void create(SoloTest &st)
+    {
+        auto &geometry = *st.geometry;
+        for (int k = 0; k <= CORNER_PAGODA; k++)
+        {
+            auto &pagoda = pagodas[k];
+            auto weight = [&](int hole)
+            {
+                auto cell = geometry.cells[hole];
+                if (cell.row >= pagodaSize || cell.column >= pagodaSize)
+                    return 0;
+                return pagodaWeights[k][cell.row][cell.column];
+            };
+            pagoda = Pagoda();
+            for (int hole = 0; hole < st.numberOfHoles; hole++)
+            {
+                if (weight(hole) == -1)
+                    pagoda.negative |= cellMask(hole);
+                else if (weight(hole) == 1)
+                    pagoda.single |= cellMask(hole);
+                else if (weight(hole) == 2)
+                    pagoda.twice |= cellMask(hole);
+            }
+            pagoda.goal = value(pagoda, st.goal);
+            // A pagoda that a jump of the board can increase would prune solvable boards, it is not used:
+            pagoda.isValid = true;
+            for (auto &jump : st.jumps)
+            {
+                if (weight(jump.to) > weight(jump.from) + weight(jump.over))
+                    pagoda.isValid = false;
+            }
+        }
+
+        // The balls grow by one step of the neighbour holes at every distance:
+        Bitboard neighbours[MAX_NUMBER_OF_HOLES] = {};
+        for (auto &jump : st.jumps)
+        {
+            neighbours[jump.from] |= cellMask(jump.over);
+            neighbours[jump.over] |= cellMask(jump.from) | cellMask(jump.to);
+            neighbours[jump.to] |= cellMask(jump.over);
+        }
+        diameter = 0;
+        for (int hole = 0; hole < st.numberOfHoles; hole++)
+        {
+            Bitboard ball = cellMask(hole);
+            for (int distance = 0; distance < st.numberOfHoles; distance++)
+            {
+                balls[hole][distance] = ball & ~cellMask(hole);
+                Bitboard grown = ball;
+                for (Bitboard rest = ball; rest != 0; rest &= rest - 1)
+                    grown |= neighbours[__builtin_ctzll(rest)];
+                // The first distance that reaches all of the holes:
+                if (grown == ball && (distance == 0 || balls[hole][distance - 1] != balls[hole][distance]))
+                    diameter = max(diameter, distance);
+                ball = grown;
+            }
+        }
+
+        for (auto &counter : numberOfPrunedNodes)
+        {
+            counter.store(0, memory_order_relaxed);
+        }
+    }
+
+    /*
+     * Returns true if the board can never reach the goal. Before a peg is
+     * jumped over or jumps, another peg must come next to it. With r pegs at
+     * most r - 2 jumps can happen before that and every jump moves a peg by
+     * 2 steps, so a peg with no other peg within the distance 2r - 3 is dead.
+     */
+    // The bits of the rules that are used on this board:
+    uint32_t rules()
+    {
+        uint32_t used = 1 << ISOLATED_PEG;
+        for (int k = 0; k <= CORNER_PAGODA; k++)
+        {
+            if (pagodas[k].isValid == true)
+                used |= 1 << k;
+        }
+        return used;
+    }
+
+    bool isPruned(Bitboard board)
+    {
+        for (int k = 0; k <= CORNER_PAGODA; k++)
+        {
+            if (pagodas[k].isValid == true && value(pagodas[k], board) < pagodas[k].goal)
+            {
+                numberOfPrunedNodes[k].fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+        int distance = 2 * countPegs(board) - 3;
+        if (distance < 1 || distance >= diameter)
+            return false;
+        for (Bitboard pegs = board; pegs != 0; pegs &= pegs - 1)
+        {
+            if ((board & balls[__builtin_ctzll(pegs)][distance]) == 0)
+            {
+                numberOfPrunedNodes[ISOLATED_PEG].fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+enum MemoryPolicy
+{
+    ABORT_SEARCH,
+    PRUNE_WORST_NODES,
+    SWITCH_TO_DFS
+};
+
+/*
+ * MemoryGovernor keeps the bytes held by the nodes, the frontiers and the
+ * caches of a search under a budget. Over 90% of the budget the search
+ * degrades: it prunes the worst nodes of the frontier or, if the frontier
+ * cannot be pruned, it continues as a depth-first search under the nodes
+ * that are already in the frontier. The search is stopped only if the
+ * whole budget is used anyway.
+ */
+class MemoryGovernor
+{
+public:
+    size_t budget = size_t(MEMORY_BUDGET_MB) * 1024 * 1024;
+    MemoryPolicy policy = PRUNE_WORST_NODES;
+    size_t currentBytes = 0;
+    size_t peakBytes = 0;
+    long numberOfPrunedNodes = 0;
+    bool isSwitchedToDFS = false;
+    /*
+     * The frontier size before the last pruning. The frontier is pruned
+     * again only after it has grown back to it, 0 if the search has been
+     * under the soft limit since then:
+     */
+    size_t regrowthMark = 0;
+
+    void update(size_t bytes)
+    {
+        currentBytes = bytes;
+        peakBytes = max(peakBytes, bytes);
+    }
+
+    bool isOverSoftLimit()
+    {
+        return currentBytes > budget / 10 * 9;
+    }
+
+    bool isOverBudget()
+    {
+        return currentBytes > budget;
+    }
+
+    // The table leaves most of the budget to the nodes of the search:
+    size_t tableMegabytes()
+    {
+        return max<size_t>(1, min<size_t>(TRANSPOSITION_TABLE_MB, budget / 1024 / 1024 / TRANSPOSITION_TABLE_BUDGET_SHARE));
+    }
+};
+
+/*
+ * The parts of an expansion, sampled by the watchdog to find where the
+ * time of a search goes:
+ */
+enum SearchPhase
+{
+    BOOKKEEPING,
+    MOVE_GENERATION,
+    SELECTION,
+    NUMBER_OF_PHASES
+};
+
+/*
+ * A worker of a parallel search publishes its own counters in its own
+ * cache line, so the workers never write to a shared line:
+ */
+struct alignas(64) WorkerTelemetry
+{
+    atomic<uint8_t> phase{BOOKKEEPING};
+    atomic<long> expandedNodes{0};
+    atomic<long> frontierSize{0};
+    atomic<int> depth{0};
+
+    void publish(long nodes, size_t frontier, int depth)
+    {
+        expandedNodes.store(nodes, memory_order_relaxed);
+        frontierSize.store(frontier, memory_order_relaxed);
+        this->depth.store(depth, memory_order_relaxed);
+    }
+
+    void enter(SearchPhase phase)
+    {
+        this->phase.store(phase, memory_order_relaxed);
+    }
+};
+
+/*
+ * Telemetry is written by the search loop with relaxed stores and
+ * increments and it is read by the watchdog, so it costs the loop a few
+ * instructions for every node and never a system call.
+ */
+struct Telemetry
+{
+    atomic<uint8_t> phase{BOOKKEEPING};
+    atomic<long> expandedNodes{0};
+    atomic<long> frontierSize{0};
+    atomic<int> depth{0};
+    // Only the watchdog writes the samples:
+    long phaseSamples[NUMBER_OF_PHASES] = {0};
+    // Only the search loop writes the counts:
+    long expansionsPerDepth[MAX_NUMBER_OF_HOLES + 2] = {0};
+    // Number of the expansions with a frontier of less than 2^k nodes:
+    long frontierHistogram[65] = {0};
+    /*
+     * The workers of the parallel searches are added before the watchdog
+     * is started, and the watchdog sums their counters with the ones above:
+     */
+    unique_ptr<WorkerTelemetry[]> workers;
+    int numberOfWorkers = 0;
+
+    void addWorkers(int count)
+    {
+        workers = make_unique<WorkerTelemetry[]>(count);
+        numberOfWorkers = count;
+    }
+
+    long totalExpandedNodes()
+    {
+        long nodes = expandedNodes.load(memory_order_relaxed);
+        for (int i = 0; i < numberOfWorkers; i++)
+            nodes += workers[i].expandedNodes.load(memory_order_relaxed);
+        return nodes;
+    }
+
+    long totalFrontierSize()
+    {
+        long size = frontierSize.load(memory_order_relaxed);
+        for (int i = 0; i < numberOfWorkers; i++)
+            size += workers[i].frontierSize.load(memory_order_relaxed);
+        return size;
+    }
+
+    int maxDepth()
+    {
+        int deepest = depth.load(memory_order_relaxed);
+        for (int i = 0; i < numberOfWorkers; i++)
+            deepest = max(deepest, workers[i].depth.load(memory_order_relaxed));
+        return deepest;
+    }
+
+    // Every worker is sampled, so the samples show the time of all of the threads:
+    void samplePhases()
+    {
+        if (numberOfWorkers == 0)
+            phaseSamples[phase.load(memory_order_relaxed)]++;
+        for (int i = 0; i < numberOfWorkers; i++)
+            phaseSamples[workers[i].phase.load(memory_order_relaxed)]++;
+    }
+
+    void record(Node &node, size_t frontier)
+    {
+        expansionsPerDepth[node.score]++;
+        frontierHistogram[64 - __builtin_clzll(frontier | 1)]++;
+        publish(expandedNodes.load(memory_order_relaxed) + 1, frontier, node.score);
+    }
+
+    void publish(long nodes, size_t frontier, int depth)
+    {
+        expandedNodes.store(nodes, memory_order_relaxed);
+        frontierSize.store(frontier, memory_order_relaxed);
+        this->depth.store(depth, memory_order_relaxed);
+    }
+
+    void enter(SearchPhase phase)
+    {
+        this->phase.store(phase, memory_order_relaxed);
+    }
+};
+
+/*
+ * Watchdog is the clock of a search. Its thread wakes up every
+ * WATCHDOG_TICK_MS milliseconds: it raises the expired flag at the time
+ * limit, samples the phase of the search, tells the checkpoint writer
+ * the time and prints a progress line every progress interval. The
+ * search loops only read the expired flag.
+ */
+class Watchdog
+{
+    thread clock;
+    atomic<bool> isRunning{false};
+    atomic<bool> expired{false};
+
+public:
+    double progressInterval = PROGRESS_INTERVAL_SECONDS;
+
+    ~Watchdog()
+    {
+        stop();
+    }
+
+    bool isExpired()
+    {
+        return expired.load(memory_order_relaxed);
+    }
+
+    void start(std::chrono::steady_clock::time_point end, Telemetry &telemetry, CheckpointWriter &checkpoints)
+    {
+        expired = false;
+        isRunning = true;
+        clock = thread([this, end, &telemetry, &checkpoints]()
+                       {
+            auto start = std::chrono::steady_clock::now();
+            auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(progressInterval));
+            auto nextProgress = start + interval;
+            auto lastProgress = start;
+            long lastNodes = 0;
+            while (isRunning.load() == true)
+            {
+                this_thread::sleep_for(std::chrono::milliseconds(WATCHDOG_TICK_MS));
+                auto now = std::chrono::steady_clock::now();
+                if (now > end)
+                    expired = true;
+                telemetry.samplePhases();
+                checkpoints.tick(now);
+                if (progressInterval <= 0 || now < nextProgress)
+                    continue;
+                long nodes = telemetry.totalExpandedNodes();
+                double seconds = std::chrono::duration<double>(now - lastProgress).count();
+                std::cout << "Progress: " + to_string(static_cast<long>(std::chrono::duration<double>(now - start).count())) +
+                                 " seconds, " + to_string(nodes) + " expanded nodes, " +
+                                 to_string(static_cast<long>((nodes - lastNodes) / seconds)) + " nodes per second, " +
+                                 to_string(telemetry.totalFrontierSize()) + " nodes in the frontier, depth " +
+                                 to_string(telemetry.maxDepth()) + ".\n"
+                          << flush;
+                lastNodes = nodes;
+                lastProgress = now;
+                nextProgress += interval;
+            } });
+    }
+
+    void stop()
+    {
+        isRunning = false;
+        if (clock.joinable() == true)
+            clock.join();
+    }
+};
+
+/*
+ * Solver class provides a problem solver framework for all 5 methods.
+ * It saves best found board, checks if stop condition is raised and the
+ * other required things that are mentioned in the homework.
+ */
+class Solver
+{
+public:
+    SoloTest st;
+    Symmetry symmetry;
+    /*
+     * Visited boards of the current search, it is shared by all 5 methods.
+     * It is only created by the searches that look boards up in it:
+     */
+    TranspositionTable table{0};
+    Pruning pruning;
+    NodeArena arena;
+    Node bestNode;
+    // The jumps from the initial board to the best node:
+    vector<uint8_t> bestPath;
+    // Time limit in minutes:
+    double timeLimit = 0;
+    // Nodes deeper than the depth limit are not expanded, 0 means no limit:
+    int depthLimit = 0;
+    // Seed of the random selections:
+    unsigned seed = 0;
+    int maxScore = 0;
+    bool stop = false;
+    long numberOfExpandedNodes = 0;
+    int maxNumberOfStoredNodes = 0;
+    long numberOfSpilledNodes = 0;
+    // The frontier nodes on the disk are not counted in maxNumberOfStoredNodes:
+    long maxNumberOfNodesOnDisk = 0;
+    // -1 if the heap allocations of the run are not counted:
+    long numberOfHeapAllocations = -1;
+    /*
+     * When the cost of a node depends on its path, a board can only be
+     * skipped when it is popped again, and the last moved peg is a part
+     * of the state. A* uses this, all of the other methods skip the
+     * duplicate boards before they are pushed to the frontier.
+     */
+    bool checkDuplicatesOnExpansion = false;
+    MemoryGovernor governor;
+    // The frontier of the search after the memory governor switches to DFS:
+    Stack fallbackStack;
+    // Arena size when the search is switched to DFS:
+    size_t fallbackArenaSize = 0;
+    // The children deeper than the depth limit of an iterative deepening step:
+    Frontier *fringe = nullptr;
+    // The arena records below this size are on the paths of the fringe nodes:
+    size_t pinnedArenaSize = 0;
+    Telemetry telemetry;
+    Watchdog watchdog;
+    // The search loop calls the frontier and the selection through their base classes:
+    bool isVirtualDispatch = false;
+    // The frontier searches write their state to checkpoints.path periodically:
+    CheckpointWriter checkpoints;
+    // The checkpoint that the search continues from instead of the first board:
+    string resumePath;
+    // The name of the method on the command line, a checkpoint is only resumed by the same method:
+    string method;
+    // The solution of the text results: boards, moves, json or none:
+    string solutionFormat = "boards";
+
+    Solver(double timeLimit)
+    {
+        setBoard(ENGLISH);
+        this->timeLimit = timeLimit;
+    }
+
+    // The tables of the search are built from the geometry of the board:
+    void setBoard(const Geometry &geometry)
+    {
+        st.createBoard(geometry);
+        symmetry.create(st);
+        pruning.create(st);
+    }
+
+    // The first node of the search:
+    Node createRoot()
+    {
+        Node root(st.board);
+        root.weight = st.boardWeight(st.board);
+        return root;
+    }
+
+    virtual ~Solver() {}
+
+    /*
+     * This function searches possible moves on a board state and returns them
+     * by assigning their parent node as the arena index of the given board.
+     */
+    void searchMoves(Node &board, uint32_t index, Children &children)
+    {
+        children.clear();
+        for (int i = 0; i < st.jumps.size(); i++)
+        {
+            auto &jump = st.jumps[i];
+            /*
+             * A jump is legal if its source and jumped holes have pegs
+             * and its target hole is free:
+             */
+            if ((board.board & jump.mask) == jump.pegs)
+            {
+                // If all conditions are true, a new board will be constructed:
+                Node node;
+                node.board = board.board ^ jump.mask;
+                node.weight = board.weight + jump.weightChange;
+                node.parent = index;
+                node.jump = i;
+                node.score = board.score + 1;
+                node.lastDeletedPegIndex = jump.over;
+                // Continuing with the peg that moved last is not a new move:
+                node.cost = board.cost;
+                if (board.jump == NO_JUMP || st.jumps[board.jump].to != jump.from)
+                    node.cost++;
+                children.push(node);
+            }
+        }
+    }
+
+    /*
+     * This is the main loop to solve the problem.
+     * All of the 5 methods use the following function. The frontier and
+     * the selection are template parameters, so every method has a loop
+     * of its own in which their calls are inlined:
+     */
+    template <typename F, typename S>
+    void solve(F &frontier, S &selection, int maxDepth = 0)
+    {
+        if (table.isCreated() == false)
+            table.create(governor.tableMegabytes());
+        // Pushing the first state of the board to the frontier:
+        arena.clear();
+        pinnedArenaSize = 0;
+        governor.isSwitchedToDFS = false;
+        checkpoints.start();
+        if (resumePath.empty() == false && loadCheckpoint(frontier) == true)
+        {
+            resume(frontier, selection, maxDepth);
+            return;
+        }
+        frontier.push(createRoot());
+        if (checkDuplicatesOnExpansion == false)
+            table.insert(symmetry.canonical(st.board));
+        resume(frontier, selection, maxDepth);
+    }
+
+    /*
+     * Copies the state of the search and hands it to the checkpoint writer.
+     * The popped node is put back to its place in the frontier. Only the
+     * searches that skip duplicates before pushing and do not keep a fringe
+     * can be checkpointed, since their frontier is the whole open state:
+     */
+    void saveCheckpoint(Frontier &frontier, Node *popped = nullptr, bool isPoppedFromFallback = false)
+    {
+        Checkpoint c;
+        if (checkDuplicatesOnExpansion == true || fringe != nullptr || frontier.snapshot(c.frontier) == false)
+        {
+            // The options are checked before the search, so this is only reported once:
+            if (checkpoints.path.empty() == false)
+                cerr << "The search cannot be checkpointed, " << checkpoints.path << " is not written." << endl;
+            // Without a path the watchdog does not raise the due flag again:
+            checkpoints.path.clear();
+            checkpoints.start();
+            return;
+        }
+        fallbackStack.snapshot(c.fallbackStack);
+        if (popped != nullptr && isPoppedFromFallback == true)
+            c.fallbackStack.push_back(*popped);
+        else if (popped != nullptr)
+            c.frontier.insert(frontier.isLastInFirstOut() ? c.frontier.end() : c.frontier.begin(), *popped);
+        c.board = st.geometry->name;
+        c.method = method;
+        c.start = st.board;
+        c.goal = st.goal;
+        c.depthLimit = depthLimit;
+        c.pruningRules = pruning.rules();
+        c.memoryPolicy = governor.policy;
+        c.isLastInFirstOut = frontier.isLastInFirstOut();
+        c.isSwitchedToDFS = governor.isSwitchedToDFS;
+        c.fallbackArenaSize = fallbackArenaSize;
+        c.maxScore = maxScore;
+        c.numberOfExpandedNodes = numberOfExpandedNodes;
+        c.maxNumberOfStoredNodes = maxNumberOfStoredNodes;
+        c.probes = table.counters.probes;
+        c.hits = table.counters.hits;
+        c.replacements = table.counters.replacements;
+        c.bestNode = bestNode;
+        c.bestPath = bestPath;
+        c.arena.reserve(arena.size());
+        for (size_t i = 0; i < arena.size(); i++)
+        {
+            c.arena.push_back(arena[i]);
+        }
+        table.snapshot(c.visited);
+        checkpoints.write(move(c));
+    }
+
+    bool loadCheckpoint(Frontier &frontier)
+    {
+        Checkpoint c;
+        if (CheckpointFile::read(c, resumePath) == false)
+        {
+            cerr << "Checkpoint " << resumePath << " cannot be read, the search starts from the first board." << endl;
+            return false;
+        }
+        if (c.board != st.geometry->name || c.start != st.board || c.goal != st.goal)
+        {
+            cerr << "Checkpoint " << resumePath << " belongs to another board, the search starts from the first board." << endl;
+            return false;
+        }
+        if (c.method != method || c.depthLimit != depthLimit || c.pruningRules != pruning.rules() ||
+            c.memoryPolicy != governor.policy || c.isLastInFirstOut != frontier.isLastInFirstOut())
+        {
+            cerr << "Checkpoint " << resumePath << " was written by " << (c.method.empty() ? "another method" : c.method)
+                 << " with other settings, the search starts from the first board." << endl;
+            return false;
+        }
+        for (auto &node : c.frontier)
+        {
+            frontier.push(node);
+        }
+        for (auto &node : c.fallbackStack)
+        {
+            fallbackStack.push(node);
+        }
+        for (auto &record : c.arena)
+        {
+            arena.add(record);
+        }
+        for (auto board : c.visited)
+        {
+            bool replaced = false;
+            table.visit(board, replaced);
+        }
+        governor.isSwitchedToDFS = c.isSwitchedToDFS;
+        fallbackArenaSize = c.fallbackArenaSize;
+        maxScore = c.maxScore;
+        numberOfExpandedNodes = c.numberOfExpandedNodes;
+        maxNumberOfStoredNodes = c.maxNumberOfStoredNodes;
+        table.counters.probes = c.probes;
+        table.counters.hits = c.hits;
+        table.counters.replacements = c.replacements;
+        bestNode = c.bestNode;
+        bestPath = c.bestPath;
+        std::cout << "Resumed from " << resumePath << " with " << c.frontier.size() + c.fallbackStack.size()
+                  << " frontier nodes and " << numberOfExpandedNodes << " expanded nodes." << endl;
+        return true;
+    }
+
+    /*
+     * Expands the nodes of the frontier until it is empty. The children
+     * deeper than maxDepth are pushed to the fringe instead and their paths
+     * are kept in the arena, so a later call can resume from the fringe.
+     * The loop through the virtual functions of the base classes is kept
+     * to measure the gain of the compiled loops (see --dispatch):
+     */
+    template <typename F, typename S>
+    void resume(F &frontier, S &selection, int maxDepth = 0)
+    {
+        if (isVirtualDispatch == true)
+            expand<Frontier, NodeSelection>(frontier, selection, maxDepth);
+        else
+            expand(frontier, selection, maxDepth);
+    }
+
+    template <typename F, typename S>
+    void expand(F &frontier, S &selection, int maxDepth)
+    {
+        Children children;
+        while (frontier.empty() == false || fallbackStack.empty() == false)
+        {
+            if (checkpoints.isDue() == true)
+                saveCheckpoint(frontier);
+            bool isFromFallback = fallbackStack.empty() == false;
+            auto currBoard = isFromFallback ? fallbackStack.pop_return() : frontier.pop_return();
+            if (checkDuplicatesOnExpansion == true && table.insert(stateKey(currBoard)) == true)
+                continue;
+
+            checkStopCriterion(frontier);
+            if (stop == true)
+            {
+                // The last checkpoint of an unfinished search is written before it returns:
+                if (checkpoints.path.empty() == false && isOptimal(bestNode) == false)
+                    saveCheckpoint(frontier, &currBoard, isFromFallback);
+                checkpoints.join();
+                return;
+            }
+            if (depthLimit != 0 && currBoard.score > depthLimit)
+                continue;
+
+            /*
+             * With a stack, the records after the parent of the popped node
+             * belong to the subtrees that are already searched:
+             */
+            if (governor.isSwitchedToDFS == true)
+                arena.rewind(max(fallbackArenaSize, currBoard.parent + size_t(1)));
+            else if (frontier.isLastInFirstOut() == true)
+                arena.rewind(max(pinnedArenaSize, currBoard.parent == NO_PARENT ? 0 : currBoard.parent + size_t(1)));
+            auto index = arena.add(currBoard);
+
+            saveProblemStateInfo(frontier, currBoard, index);
+            if (pruning.isPruned(currBoard.board) == true)
+                continue;
+
+            telemetry.enter(MOVE_GENERATION);
+            searchMoves(currBoard, index, children);
+            telemetry.enter(SELECTION);
+            selection.select(children);
+            telemetry.enter(BOOKKEEPING);
+            for (auto &node : children)
+            {
+                // The boards that are reached before with another move order are skipped:
+                if (checkDuplicatesOnExpansion == false && table.insert(symmetry.canonical(node.board)) == true)
+                    continue;
+                // An expanded state is already reached with its fewest moves:
+                if (checkDuplicatesOnExpansion == true && table.contains(stateKey(node)) == true)
+                    continue;
+                if (maxDepth != 0 && node.score > maxDepth)
+                {
+                    fringe->push(node);
+                    pinnedArenaSize = index + size_t(1);
+                }
+                else if (governor.isSwitchedToDFS == true)
+                    fallbackStack.push(node);
+                else
+                    frontier.push(node);
+            }
+        }
+        checkpoints.join();
+    }
+
+    // The board and the hole of the last moved peg above the board bits:
+    Bitboard stateKey(Node &node)
+    {
+        if (node.jump == NO_JUMP)
+            return node.board;
+        return node.board | Bitboard(st.jumps[node.jump].to + 1) << st.numberOfHoles;
+    }
+
+    template <typename F>
+    void checkStopCriterion(F &frontier)
+    {
+        if (watchdog.isExpired() == true)
+            stop = true;
+
+        governor.update(searchBytes(frontier));
+        if (governor.isOverSoftLimit() == true)
+            degradeSearch(frontier);
+        else
+            governor.regrowthMark = 0;
+    }
+
+    // The nodes that are spilled to the disk are not counted:
+    size_t searchBytes(Frontier &frontier)
+    {
+        return frontier.bytes() + fallbackStack.bytes() + arena.bytes() + table.bytes() +
+               (fringe == nullptr ? 0 : fringe->bytes());
+    }
+
+    /*
+     * The search first prunes the frontier, and switches to DFS if it is
+     * still over the soft limit. It is stopped only if it is over the
+     * budget after both of them. The frontier is pruned once when the
+     * search crosses the soft limit, and again only after it has regrown,
+     * so the memory of the arena and the table cannot empty it pop by pop:
+     */
+    void degradeSearch(Frontier &frontier)
+    {
+        if (governor.policy == PRUNE_WORST_NODES && frontier.size() >= governor.regrowthMark)
+        {
+            governor.regrowthMark = max<size_t>(frontier.size(), 1);
+            governor.numberOfPrunedNodes += frontier.prune(frontier.size() / 2);
+            governor.update(searchBytes(frontier));
+        }
+        // A stack based search is already a depth-first search:
+        if (governor.policy != ABORT_SEARCH && governor.isOverSoftLimit() == true &&
+            governor.isSwitchedToDFS == false && frontier.isLastInFirstOut() == false)
+        {
+            governor.isSwitchedToDFS = true;
+            fallbackArenaSize = arena.size();
+        }
+        if (governor.isOverBudget() == true)
+        {
+            stop = true;
+            maxScore = -1;
+        }
+    }
+
+    template <typename F>
+    void saveProblemStateInfo(F &frontier, Node &node, uint32_t index)
+    {
+        numberOfExpandedNodes++;
+        size_t size = frontier.size() + (fringe == nullptr ? 0 : fringe->size());
+        size_t memorySize = frontier.memorySize() + (fringe == nullptr ? 0 : fringe->memorySize());
+        maxNumberOfStoredNodes = max(static_cast<int>(memorySize), maxNumberOfStoredNodes);
+        maxNumberOfNodesOnDisk = max(static_cast<long>(size - memorySize), maxNumberOfNodesOnDisk);
+        telemetry.record(node, size);
+        checkBestNode(node, index);
+    }
+
+    /*
+     * The path of the best node is copied out of the arena
+     * because the arena can be rewound later:
+     */
+    // The optimal board has a single peg in the goal hole:
+    bool isOptimal(Node &node)
+    {
+        return node.board == st.goal;
+    }
+
+    void checkBestNode(Node &node, uint32_t index)
+    {
+        if (isOptimal(node))
+        {
+            maxScore = node.score;
+            stop = true;
+            bestNode = node;
+            bestPath = arena.path(index);
+        }
+        else if (node.score > maxScore)
+        {
+            maxScore = node.score;
+            bestNode = node;
+            bestPath = arena.path(index);
+        }
+    }
+
+    /*
+     * The results are written to one buffer and flushed once, so the
+     * solution does not cost a flush for every line of its boards:
+     */
+    void printResults(double runtime)
+    {
+        ostringstream out;
+        // The memory budget can stop the search before any node is recorded:
+        if (maxScore == -1)
+        {
+            out << "No solution found - Out of Memory\n";
+            if (bestNode.board != 0)
+                writeSolution(out);
+        }
+        else if (maxScore == 0 || bestNode.board == 0)
+        {
+            out << "No solution found - Time Limit\n";
+        }
+        else if (isOptimal(bestNode) == true)
+        {
+            out << "Optimum solution found.\n";
+            writeSolution(out);
+        }
+        else
+        {
+            out << "Sub-optimum Solution Found with " << countPegs(bestNode.board) << " remaining pegs.\n";
+            writeSolution(out);
+        }
+        out << "Runtime: " << runtime / 60 << " minutes.\n";
+        out << "Number of expanded nodes: " << numberOfExpandedNodes << '\n';
+        out << "Max number of nodes stored in the memory: " << maxNumberOfStoredNodes << '\n';
+        if (numberOfHeapAllocations >= 0)
+            out << "Number of heap allocations: " << numberOfHeapAllocations << ", "
+                << (numberOfExpandedNodes > 0 ? double(numberOfHeapAllocations) / numberOfExpandedNodes : 0)
+                << " per expanded node.\n";
+        out << "Memory usage: " << governor.currentBytes << " bytes, peak: " << governor.peakBytes
+            << " bytes, budget: " << governor.budget << " bytes.\n";
+        if (governor.numberOfPrunedNodes > 0)
+            out << "Number of nodes pruned for the memory budget: " << governor.numberOfPrunedNodes << '\n';
+        if (governor.isSwitchedToDFS == true)
+            out << "Search is switched to DFS for the memory budget.\n";
+        if (numberOfSpilledNodes > 0)
+            out << "Number of nodes spilled to the disk: " << numberOfSpilledNodes
+                << ", at most " << maxNumberOfNodesOnDisk << " of them on the disk at once\n";
+        if (checkpoints.numberOfCheckpoints > 0 || checkpoints.numberOfFailedCheckpoints > 0)
+            out << "Number of checkpoints written to " << checkpoints.path << ": "
+                << checkpoints.numberOfCheckpoints << ", failed: " << checkpoints.numberOfFailedCheckpoints << '\n';
+        out << "Number of pruned nodes: " << pruning.numberOfPrunedNodes[ODD_HOLES_PAGODA]
+            << " by the odd holes pagoda, " << pruning.numberOfPrunedNodes[CORNER_PAGODA]
+            << " by the corner pagoda, " << pruning.numberOfPrunedNodes[ISOLATED_PEG]
+            << " by the isolated pegs.\n";
+        out << "Transposition table hit rate: " << table.counters.hitRate() << "% ("
+            << table.counters.hits << " duplicates in " << table.counters.probes << " lookups, "
+            << table.counters.replacements << " replacements)\n";
+        out << "Expanded nodes per second: " << static_cast<long>(runtime > 0 ? numberOfExpandedNodes / runtime : 0) << '\n';
+        printTelemetry(out);
+        out << '\n';
+        cout << out.str() << flush;
+    }
+
+    /*
+     * The counts of the search loops, the other searches do not record them.
+     * The workers of the parallel searches only publish their phases:
+     */
+    void printTelemetry(ostream &out)
+    {
+        long samples = 0;
+        for (auto count : telemetry.frontierHistogram)
+        {
+            samples += count;
+        }
+        if (samples == 0 && telemetry.numberOfWorkers == 0)
+            return;
+        if (samples > 0)
+        {
+            out << "Expanded nodes per depth:";
+            for (int depth = 0; depth < MAX_NUMBER_OF_HOLES + 2; depth++)
+            {
+                if (telemetry.expansionsPerDepth[depth] > 0)
+                    out << " " << depth << ":" << telemetry.expansionsPerDepth[depth];
+            }
+            out << "\nFrontier size histogram (expansions with a frontier below the size):";
+            for (int k = 0; k < 65; k++)
+            {
+                if (telemetry.frontierHistogram[k] > 0)
+                    out << " <2^" << k << ":" << telemetry.frontierHistogram[k];
+            }
+            out << '\n';
+        }
+        long phases = telemetry.phaseSamples[MOVE_GENERATION] + telemetry.phaseSamples[SELECTION] +
+                      telemetry.phaseSamples[BOOKKEEPING];
+        out << "Time in move generation: " << 100.0 * telemetry.phaseSamples[MOVE_GENERATION] / max(phases, 1L)
+            << "%, selection: " << 100.0 * telemetry.phaseSamples[SELECTION] / max(phases, 1L)
+            << "%, bookkeeping: " << 100.0 * telemetry.phaseSamples[BOOKKEEPING] / max(phases, 1L)
+            << "% (" << phases << " samples)\n";
+    }
+
+    /*
+     * The layered searches only keep canonical boards. This function turns
+     * a chain of canonical boards, starting from the initial board, to the
+     * real jumps by selecting the jump whose child has the next canonical board:
+     */
+    vector<uint8_t> replayCanonicalPath(vector<Bitboard> &chain)
+    {
+        vector<uint8_t> path;
+        Bitboard board = st.board;
+        for (int i = 1; i < chain.size(); i++)
+        {
+            for (int j = 0; j < st.jumps.size(); j++)
+            {
+                auto &jump = st.jumps[j];
+                if ((board & jump.mask) == jump.pegs &&
+                    symmetry.canonical(board ^ jump.mask) == chain[i])
+                {
+                    board ^= jump.mask;
+                    path.push_back(j);
+                    break;
+                }
+            }
+        }
+        return path;
+    }
+
+    /*
+     * Replays the jumps of the best path from the initial board. The path
+     * is a solution of the search only if every jump is legal on the board
+     * it is applied to and the last board is the best node:
+     */
+    bool verifySolution()
+    {
+        Bitboard board = st.board;
+        for (auto jump : bestPath)
+        {
+            if (jump >= st.jumps.size() || (board & st.jumps[jump].mask) != st.jumps[jump].pegs)
+                return false;
+            board ^= st.jumps[jump].mask;
+        }
+        return board == bestNode.board;
+    }
+
+    /*
+     * The jumps of the best path in the compact notation, the holes of
+     * every jump are separated by dashes and the jumps by spaces:
+     */
+    string movesToString()
+    {
+        string moves;
+        for (auto jump : bestPath)
+        {
+            auto &j = st.jumps[jump];
+            if (moves.empty() == false)
+                moves += ' ';
+            moves += cellName(*st.geometry, j.from) + '-' + cellName(*st.geometry, j.over) + '-' + cellName(*st.geometry, j.to);
+        }
+        return moves;
+    }
+
+    // The jumps of the best path as a JSON array of [from, over, to] arrays:
+    string movesToJson()
+    {
+        string moves = "[";
+        for (auto jump : bestPath)
+        {
+            auto &j = st.jumps[jump];
+            if (moves.size() > 1)
+                moves += ',';
+            moves += "[\"" + cellName(*st.geometry, j.from) + "\",\"" + cellName(*st.geometry, j.over) +
+                     "\",\"" + cellName(*st.geometry, j.to) + "\"]";
+        }
+        return moves + "]";
+    }
+
+    /*
+     * Writes the best path in the solution format: the board states,
+     * which are rebuilt by replaying the jumps from the initial board,
+     * the compact moves or a JSON object.
+     */
+    void writeSolution(ostream &out)
+    {
+        bool isVerified = verifySolution();
+        if (solutionFormat == "json")
+        {
+            out << "{\"board\":\"" << st.geometry->name << "\",\"goal\":\""
+                << cellName(*st.geometry, st.geometry->goalHole) << "\",\"jumps\":" << bestPath.size()
+                << ",\"moves\":" << movesToJson() << ",\"verified\":" << (isVerified ? "true" : "false") << "}\n";
+            return;
+        }
+        out << "Solution of " << bestPath.size() << " jumps is " << (isVerified ? "verified" : "NOT verified")
+            << " by replaying it.\n";
+        if (solutionFormat == "moves")
+        {
+            out << "Moves: " << movesToString() << '\n';
+            return;
+        }
+        if (solutionFormat != "boards")
+            return;
+        string states = "Board states:\n";
+        Bitboard board = st.board;
+        int counter = 0;
+        states += to_string(counter++) + ". State: \n";
+        renderBoard(states, board);
+        for (auto jump : bestPath)
+        {
+            board ^= st.jumps[jump].mask;
+            states += to_string(counter++) + ". State: \n";
+            renderBoard(states, board);
+        }
+        out << states;
+    }
+
+    void renderBoard(string &out, Bitboard board)
+    {
+        for (int i = 0; i < st.geometry->size; i++)
+        {
+            for (int j = 0; j < st.geometry->size; j++)
+            {
+                if (st.isHole(i, j) == false)
+                    out += ' ';
+                else if ((board & cellMask(st.geometry->holeIndex[i][j])) == 0)
+                    out += '.';
+                else
+                    out += 'O';
+            }
+            out += '\n';
+        }
+        out += '\n';
+    }
+
+    virtual void run(std::chrono::steady_clock::time_point timeLimit) = 0;
+};
+
+class Solve_DFS : public Solver
+{
+public:
+    Solve_DFS(double timeLimit) : Solver(timeLimit)
+    {
+        std::cout << "Search Method: Depth-First Search, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        Stack s;
+        IndexFirst selection;
+        solve(s, selection);
+    }
+};
+
+/*
+ * BFS and IDS keep the frontier in the memory, or spill
+ * it to the given directory if a directory is given.
+ */
+class Solve_BFS : public Solver
+{
+public:
+    string spillDirectory;
+    Solve_BFS(double timeLimit, string spillDirectory = "") : Solver(timeLimit)
+    {
+        std::cout << "Search Method: Breadth First Search, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+        this->spillDirectory = spillDirectory;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        IndexFirst selection;
+        if (spillDirectory.empty() == true)
+        {
+            Queue q;
+            solve(q, selection);
+            return;
+        }
+        SpillingQueue q(spillDirectory);
+        solve(q, selection);
+        numberOfSpilledNodes = q.numberOfSpilledNodes();
+    }
+};
+
+class Solve_IDS : public Solver
+{
+public:
+    string spillDirectory;
+    Solve_IDS(double timeLimit, int depthLimit, string spillDirectory = "") : Solver(timeLimit)
+    {
+        std::cout << "Search Method: Iterative Deepening Search, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+        this->depthLimit = depthLimit;
+        this->spillDirectory = spillDirectory;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        if (spillDirectory.empty() == true)
+        {
+            Stack s, next;
+            deepen(s, next);
+            return;
+        }
+        SpillingStack s(spillDirectory), next(spillDirectory);
+        deepen(s, next);
+        numberOfSpilledNodes += s.numberOfSpilledNodes() + next.numberOfSpilledNodes();
+    }
+
+    /*
+     * Every iteration only expands the nodes that were cut off by the previous
+     * depth limit, instead of searching the tree again from the first board.
+     * The cut off nodes of an iteration are the frontier of the next one.
+     */
+    template <typename F>
+    void deepen(F &first, F &second)
+    {
+        IndexFirst selection;
+        F *s = &first;
+        F *next = &second;
+        int lastDepth = depthLimit == 0 ? st.numberOfHoles : depthLimit;
+        for (int i = 1; i <= lastDepth; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            long numberOfNodes = numberOfExpandedNodes;
+            fringe = next;
+            if (i == 1)
+                solve(*s, selection, i);
+            else
+                resume(*s, selection, i);
+            fringe = nullptr;
+            std::cout << "Iteration " << i << ": " << numberOfExpandedNodes - numberOfNodes
+                      << " expanded nodes, " << next->size() << " cut off nodes, "
+                      << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                      << " seconds." << endl;
+            if (stop == true || next->empty() == true)
+                break;
+            swap(s, next);
+        }
+    }
+};
+
+class Solve_DFSR : public Solver
+{
+public:
+    Solve_DFSR(double timeLimit, unsigned seed = random_device{}()) : Solver(timeLimit)
+    {
+        this->seed = seed;
+        std::cout << "Search Method: Depth-First Search with Random Selection, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        Random selection(seed);
+        Stack s;
+        solve(s, selection);
+    }
+};
+
+class Solve_DFSH : public Solver
+{
+public:
+    Solve_DFSH(double timeLimit) : Solver(timeLimit)
+    {
+        std::cout << "Search Method: Depth-First Search with a Node Selection Heuristic, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        Heuristic selection;
+        Stack s;
+        solve(s, selection);
+    }
+};
+
+/*
+ * A* expands the nodes in the order of their number of moves plus the
+ * estimate of MoveCost, so the first solution it finds has the fewest moves.
+ */
+class Solve_AStar : public Solver
+{
+public:
+    Solve_AStar(double timeLimit) : Solver(timeLimit)
+    {
+        std::cout << "Search Method: A* Search, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+        checkDuplicatesOnExpansion = true;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        MoveCost cost(st);
+        BucketQueue q(cost);
+        IndexFirst selection;
+        solve(q, selection);
+    }
+};
+
+/*
+ * IDA* is a depth-first search that does not expand the nodes whose
+ * number of moves plus estimate is over a threshold. Every iteration
+ * raises the threshold to the smallest value that was over it before.
+ * It only stores the current path, so it does not use the transposition
+ * table either.
+ */
+class Solve_IDAStar : public Solver
+{
+public:
+    Solve_IDAStar(double timeLimit) : Solver(timeLimit)
+    {
+        std::cout << "Search Method: IDA* Search, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        MoveCost cost(st);
+        IndexFirst selection;
+        Children children;
+        Node root = createRoot();
+        int threshold = cost.total(root);
+        while (stop == false)
+        {
+            int nextThreshold = INT32_MAX;
+            Stack s;
+            arena.clear();
+            s.push(root);
+            while (s.empty() == false)
+            {
+                auto currBoard = s.pop_return();
+                checkStopCriterion(s);
+                if (stop == true)
+                    return;
+                if (depthLimit != 0 && currBoard.score > depthLimit)
+                    continue;
+
+                arena.rewind(currBoard.parent == NO_PARENT ? 0 : currBoard.parent + 1);
+                auto index = arena.add(currBoard);
+                saveProblemStateInfo(s, currBoard, index);
+                if (stop == true)
+                    return;
+                if (pruning.isPruned(currBoard.board) == true)
+                    continue;
+
+                telemetry.enter(MOVE_GENERATION);
+                searchMoves(currBoard, index, children);
+                telemetry.enter(SELECTION);
+                selection.select(children);
+                telemetry.enter(BOOKKEEPING);
+                for (auto &node : children)
+                {
+                    int f = cost.total(node);
+                    if (f > threshold)
+                    {
+                        nextThreshold = min(nextThreshold, f);
+                        continue;
+                    }
+                    s.push(node);
+                }
+            }
+            // The whole tree is searched without a solution:
+            if (nextThreshold == INT32_MAX)
+                return;
+            threshold = nextThreshold;
+        }
+    }
+};
+
+/*
+ * Depth-first search that remembers the dead boards, the boards whose
+ * whole subtree is searched without reaching the goal. A jump always
+ * removes a peg, so a board is never on its own path and every board is
+ * searched once. The solvers of a batch share a BoardCache: a solution
+ * adds its boards to the solvable boards, and a search that reaches one
+ * of them follows the children that are solvable first, which replays
+ * the found solution without searching. The lookups are counted in the
+ * counters of the table. The depth limit is not used, since a partly
+ * searched board is not dead.
+ */
+class Solve_Memo : public Solver
+{
+    unique_ptr<BoardCache> ownCache;
+    vector<uint8_t> path;
+    // Number of the dead boards that this search added to the cache:
+    int numberOfDeadBoards = 0;
+
+public:
+    BoardCache *cache = nullptr;
+
+    Solve_Memo(double timeLimit) : Solver(timeLimit)
+    {
+        std::cout << "Search Method: Depth-First Search with Dead Boards, Time Limit: "
+                  << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        if (cache == nullptr)
+        {
+            ownCache = make_unique<BoardCache>(*st.geometry);
+            cache = ownCache.get();
+        }
+        // The tables of the cache have a fixed size, a shared cache is counted by every job:
+        governor.update(cache->bytes());
+        path.clear();
+        if (search(createRoot()) == false)
+            return;
+        Bitboard board = st.board;
+        cache->addSolvable(cache->key(board, st.geometry->goalHole));
+        for (auto jump : bestPath)
+        {
+            board ^= st.jumps[jump].mask;
+            cache->addSolvable(cache->key(board, st.geometry->goalHole));
+        }
+    }
+
+    // Returns true when the goal is reached from the node:
+    bool search(Node node)
+    {
+        if (watchdog.isExpired() == true)
+        {
+            stop = true;
+            return false;
+        }
+        numberOfExpandedNodes++;
+        telemetry.record(node, path.size());
+        maxNumberOfStoredNodes = max(static_cast<int>(path.size()) + numberOfDeadBoards, maxNumberOfStoredNodes);
+        if (node.score > maxScore || isOptimal(node) == true)
+        {
+            maxScore = node.score;
+            bestNode = node;
+            bestPath = path;
+        }
+        if (isOptimal(node) == true)
+        {
+            stop = true;
+            return true;
+        }
+        if (pruning.isPruned(node.board) == true)
+            return false;
+        auto key = cache->key(node.board, st.geometry->goalHole);
+        table.counters.probes++;
+        if (cache->isDead(key) == true)
+        {
+            table.counters.hits++;
+            return false;
+        }
+
+        Children children;
+        telemetry.enter(MOVE_GENERATION);
+        searchMoves(node, NO_PARENT, children);
+        telemetry.enter(SELECTION);
+        if (cache->isSolvable(key) == true)
+        {
+            stable_partition(children.begin(), children.end(), [&](Node &child)
+                             { return cache->isSolvable(cache->key(child.board, st.geometry->goalHole)); });
+        }
+        telemetry.enter(BOOKKEEPING);
+        for (auto &child : children)
+        {
+            path.push_back(child.jump);
+            if (search(child) == true)
+                return true;
+            path.pop_back();
+            if (stop == true)
+                return false;
+        }
+        numberOfDeadBoards += cache->addDead(key);
+        return false;
+    }
+};
+
+/*
+ * Sorts the boards with a least significant digit radix sort on 8-bit
+ * digits. A digit that is the same for all of the boards is skipped.
+ */
+void radixSort(vector<Bitboard> &boards, vector<Bitboard> &buffer, int bits)
+{
+    buffer.resize(boards.size());
+    for (int shift = 0; shift < bits && boards.empty() == false; shift += 8)
+    {
+        size_t counts[256] = {0};
+        for (auto board : boards)
+        {
+            counts[(board >> shift) & 0xFF]++;
+        }
+        if (counts[(boards[0] >> shift) & 0xFF] == boards.size())
+            continue;
+        size_t offset = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            auto count = counts[i];
+            counts[i] = offset;
+            offset += count;
+        }
+        for (auto board : boards)
+        {
+            buffer[counts[(board >> shift) & 0xFF]++] = board;
+        }
+        boards.swap(buffer);
+    }
+}
+
+/*
+ * Solve_LayeredBFS is a level-synchronous breadth-first search. A layer
+ * is a flat sorted array of the canonical boards of one depth. Every
+ * thread expands a part of the layer, and radix sorts and deduplicates its
+ * children; the parts are then merged into the next layer. All of the
+ * layers are kept, they are the only thing needed to recover the path,
+ * so the whole reachable state space of the board fits in the memory.
+ */
+class Solve_LayeredBFS : public Solver
+{
+public:
+    int numberOfThreads = 1;
+    vector<vector<Bitboard>> layers;
+    // The boards that cannot reach the goal are not expanded:
+    bool isPruningLayers = true;
+
+    Solve_LayeredBFS(double timeLimit, int numberOfThreads, string name = "Layered Breadth First Search") : Solver(timeLimit)
+    {
+        this->numberOfThreads = max(numberOfThreads, 1);
+        std::cout << "Search Method: " << name << " with " << this->numberOfThreads
+                  << " threads, Time Limit: " << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        layers.push_back({symmetry.canonical(st.board)});
+        long storedNodes = 1;
+        while (stop == false)
+        {
+            checkBestLayer();
+            if (stop == true || layers.size() == depthLimit)
+                break;
+            vector<Bitboard> next;
+            if (expandLayer(layers.back(), next) == false)
+            {
+                stop = true;
+                break;
+            }
+            numberOfExpandedNodes += layers.back().size();
+            if (next.empty() == true)
+                break;
+            storedNodes += next.size();
+            maxNumberOfStoredNodes = max(static_cast<int>(storedNodes), maxNumberOfStoredNodes);
+            layers.push_back(move(next));
+            /*
+             * A part of a layer would not be a complete enumeration,
+             * so this search stops when it is over the memory budget:
+             */
+            if (governor.isOverBudget() == true)
+            {
+                stop = true;
+                maxScore = -1;
+            }
+        }
+        recoverBestPath();
+    }
+
+    void checkBestLayer()
+    {
+        auto &layer = layers.back();
+        int score = layers.size();
+        Node node(layer[0]);
+        node.score = score;
+        if (binary_search(layer.begin(), layer.end(), symmetry.canonical(st.goal)))
+            node.board = st.goal;
+        if (isOptimal(node))
+            stop = true;
+        if (score > maxScore)
+        {
+            maxScore = score;
+            bestNode = node;
+        }
+    }
+
+    /*
+     * Expands the layer on all of the threads. It returns false if the
+     * time limit is reached before the layer is completed. A backward
+     * expansion undoes the jumps, so its boards have one more peg:
+     */
+    bool expandLayer(vector<Bitboard> &layer, vector<Bitboard> &next, bool isBackward = false)
+    {
+        telemetry.publish(numberOfExpandedNodes, layer.size(), layers.size());
+        vector<vector<Bitboard>> parts(numberOfThreads);
+        // The children of every part before its duplicates are removed:
+        vector<size_t> children(numberOfThreads, 0);
+        atomic<bool> timeout{false};
+        vector<thread> threads;
+        for (int t = 0; t < numberOfThreads; t++)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                size_t begin = layer.size() * t / numberOfThreads;
+                size_t last = layer.size() * (t + 1) / numberOfThreads;
+                auto &part = parts[t];
+                for (size_t i = begin; i < last; i++)
+                {
+                    if ((i & 4095) == 0 && (timeout == true || watchdog.isExpired() == true))
+                    {
+                        timeout = true;
+                        return;
+                    }
+                    // The boards of a backward search can always reach the goal:
+                    if (isBackward == false && isPruningLayers == true && pruning.isPruned(layer[i]) == true)
+                        continue;
+                    for (auto &jump : st.jumps)
+                    {
+                        if ((layer[i] & jump.mask) == (isBackward == true ? cellMask(jump.to) : jump.pegs))
+                            part.push_back(symmetry.canonical(layer[i] ^ jump.mask));
+                    }
+                }
+                children[t] = part.size();
+                vector<Bitboard> buffer;
+                radixSort(part, buffer, st.numberOfHoles);
+                part.erase(unique(part.begin(), part.end()), part.end()); });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        if (timeout == true)
+            return false;
+        mergeParts(parts, next);
+        // All of the children are looked up, so the hit rate does not depend on the number of the parts:
+        size_t total = 0;
+        for (auto count : children)
+        {
+            total += count;
+        }
+        table.counters.probes += total;
+        table.counters.hits += total - next.size();
+        return true;
+    }
+
+    virtual size_t layerBytes()
+    {
+        size_t bytes = 0;
+        for (auto &layer : layers)
+        {
+            bytes += layer.capacity() * sizeof(Bitboard);
+        }
+        return bytes;
+    }
+
+    // Merges the sorted parts of the threads without the duplicates:
+    void mergeParts(vector<vector<Bitboard>> &parts, vector<Bitboard> &next)
+    {
+        size_t total = 0;
+        for (auto &part : parts)
+        {
+            total += part.size();
+        }
+        next.reserve(total);
+        size_t bytes = next.capacity() * sizeof(Bitboard) + layerBytes();
+        for (auto &part : parts)
+        {
+            bytes += part.capacity() * sizeof(Bitboard);
+        }
+        governor.update(bytes);
+        vector<size_t> positions(parts.size(), 0);
+        while (true)
+        {
+            int smallest = -1;
+            for (int i = 0; i < parts.size(); i++)
+            {
+                if (positions[i] < parts[i].size() &&
+                    (smallest == -1 || parts[i][positions[i]] < parts[smallest][positions[smallest]]))
+                    smallest = i;
+            }
+            if (smallest == -1)
+                break;
+            auto board = parts[smallest][positions[smallest]++];
+            if (next.empty() == true || next.back() != board)
+                next.push_back(board);
+        }
+    }
+
+    /*
+     * Walks back from the best board; a parent is found by undoing a jump
+     * and searching its canonical board in the previous layer:
+     */
+    void recoverBestPath()
+    {
+        if (maxScore == 0)
+            return;
+        vector<Bitboard> chain = {symmetry.canonical(bestNode.board)};
+        for (int depth = maxScore - 1; depth > 0; depth--)
+        {
+            auto board = chain.back();
+            auto &layer = layers[depth - 1];
+            for (auto &jump : st.jumps)
+            {
+                auto parent = symmetry.canonical(board ^ jump.mask);
+                if ((board & jump.mask) == cellMask(jump.to) &&
+                    binary_search(layer.begin(), layer.end(), parent))
+                {
+                    chain.push_back(parent);
+                    break;
+                }
+            }
+        }
+        reverse(chain.begin(), chain.end());
+        bestPath = replayCanonicalPath(chain);
+        bestNode.board = st.board;
+        for (auto jump : bestPath)
+        {
+            bestNode.board ^= st.jumps[jump].mask;
+        }
+    }
+};
+
+/*
+ * Solve_Bidirectional runs the layered search from both ends. The forward
+ * layers start from the initial board and the backward layers start from
+ * the goal board and undo the jumps, so a backward layer has the canonical
+ * boards that can reach the goal. The side with the smaller last layer is
+ * expanded until both of them have the same number of pegs, and a board in
+ * both of the last layers is on a solution. The symmetries keep the goal
+ * hole in its place, so any board of a backward canonical board reaches it.
+ */
+class Solve_Bidirectional : public Solve_LayeredBFS
+{
+public:
+    vector<vector<Bitboard>> backwardLayers;
+
+    Solve_Bidirectional(double timeLimit, int numberOfThreads)
+        : Solve_LayeredBFS(timeLimit, numberOfThreads, "Bidirectional Layered Search")
+    {
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        layers.push_back({symmetry.canonical(st.board)});
+        backwardLayers.push_back({symmetry.canonical(st.goal)});
+        long storedNodes = 2;
+        checkBestLayer();
+        while (stop == false && forwardPegs() > backwardPegs())
+        {
+            bool isBackward = backwardLayers.back().size() < layers.back().size();
+            auto &side = isBackward == true ? backwardLayers : layers;
+            vector<Bitboard> next;
+            if (expandLayer(side.back(), next, isBackward) == false)
+            {
+                stop = true;
+                break;
+            }
+            numberOfExpandedNodes += side.back().size();
+            storedNodes += next.size();
+            maxNumberOfStoredNodes = max(static_cast<int>(storedNodes), maxNumberOfStoredNodes);
+            side.push_back(move(next));
+            std::cout << (isBackward == true ? "Backward" : "Forward") << " layer with "
+                      << (isBackward == true ? backwardPegs() : forwardPegs()) << " pegs: "
+                      << side.back().size() << " boards." << endl;
+            // There is no solution if a side has no boards left:
+            if (side.back().empty() == true)
+            {
+                side.pop_back();
+                break;
+            }
+            if (isBackward == false)
+                checkBestLayer();
+            if (governor.isOverBudget() == true)
+            {
+                stop = true;
+                maxScore = -1;
+            }
+        }
+        bool isMet = maxScore != -1 && forwardPegs() == backwardPegs() && meet() == true;
+        recoverBestPath();
+        if (isMet == true)
+            followBackwardLayers();
+    }
+
+    int forwardPegs()
+    {
+        return countPegs(st.board) - (layers.size() - 1);
+    }
+
+    int backwardPegs()
+    {
+        return countPegs(st.goal) + (backwardLayers.size() - 1);
+    }
+
+    size_t layerBytes()
+    {
+        size_t bytes = Solve_LayeredBFS::layerBytes();
+        for (auto &layer : backwardLayers)
+        {
+            bytes += layer.capacity() * sizeof(Bitboard);
+        }
+        return bytes;
+    }
+
+    /*
+     * The smallest board of both of the last layers becomes the best node,
+     * so recoverBestPath finds the forward half of the path to it:
+     */
+    bool meet()
+    {
+        auto &forward = layers.back();
+        auto &backward = backwardLayers.back();
+        vector<Bitboard> boards;
+        set_intersection(forward.begin(), forward.end(), backward.begin(), backward.end(), back_inserter(boards));
+        std::cout << "Number of meeting boards: " << boards.size() << endl;
+        if (boards.empty() == true)
+            return false;
+        maxScore = layers.size();
+        bestNode.board = boards[0];
+        return true;
+    }
+
+    /*
+     * The backward half of the path is found by taking the jump whose child
+     * is in the next backward layer, until the goal board is reached:
+     */
+    void followBackwardLayers()
+    {
+        for (int k = backwardLayers.size() - 2; k >= 0; k--)
+        {
+            auto &layer = backwardLayers[k];
+            for (int j = 0; j < st.jumps.size(); j++)
+            {
+                auto &jump = st.jumps[j];
+                if ((bestNode.board & jump.mask) == jump.pegs &&
+                    binary_search(layer.begin(), layer.end(), symmetry.canonical(bestNode.board ^ jump.mask)))
+                {
+                    bestNode.board ^= jump.mask;
+                    bestPath.push_back(j);
+                    break;
+                }
+            }
+        }
+        maxScore = bestPath.size() + 1;
+        bestNode.score = maxScore;
+        stop = true;
+    }
+};
+
+/*
+ * Solve_Beam is a layered search that keeps only the best "width" boards
+ * of every depth, ranked by the board weights of the heuristic (see
+ * Heuristic). Heuristic::select only halves the children of one node, so
+ * its work is unbounded; here every layer has at most width boards, so the
+ * time and memory of the search only depend on the width.
+ */
+class Solve_Beam : public Solve_LayeredBFS
+{
+public:
+    int width;
+
+    Solve_Beam(double timeLimit, int numberOfThreads, int width)
+        : Solve_LayeredBFS(timeLimit, numberOfThreads, "Beam Search (width " + to_string(width) + ")")
+    {
+        this->width = max(width, 1);
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        layers.push_back({symmetry.canonical(st.board)});
+        long storedNodes = 1;
+        while (stop == false)
+        {
+            checkBestLayer();
+            if (stop == true || layers.size() == depthLimit)
+                break;
+            vector<Bitboard> next;
+            if (expandBeam(layers.back(), next) == false)
+            {
+                stop = true;
+                break;
+            }
+            numberOfExpandedNodes += layers.back().size();
+            if (next.empty() == true)
+                break;
+            storedNodes += next.size();
+            maxNumberOfStoredNodes = max(static_cast<int>(storedNodes), maxNumberOfStoredNodes);
+            layers.push_back(move(next));
+            governor.update(layerBytes());
+        }
+        recoverBestPath();
+    }
+
+    // Keeps the best width boards of the weighted boards, the lower weight is better:
+    void selectBest(vector<pair<int, Bitboard>> &boards)
+    {
+        sort(boards.begin(), boards.end(),
+             [](const auto &l, const auto &r)
+             {
+                 return l.second < r.second;
+             });
+        boards.erase(unique(boards.begin(), boards.end()), boards.end());
+        if (boards.size() <= width)
+            return;
+        nth_element(boards.begin(), boards.begin() + width, boards.end());
+        boards.resize(width);
+    }
+
+    /*
+     * Every thread scores the children of its part of the layer and keeps
+     * its best width boards. A board has the same weight in every part, so
+     * the best width boards of the layer are among the kept ones.
+     */
+    bool expandBeam(vector<Bitboard> &layer, vector<Bitboard> &next)
+    {
+        telemetry.publish(numberOfExpandedNodes, layer.size(), layers.size());
+        vector<vector<pair<int, Bitboard>>> parts(numberOfThreads);
+        atomic<bool> timeout{false};
+        vector<thread> threads;
+        for (int t = 0; t < numberOfThreads; t++)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                size_t begin = layer.size() * t / numberOfThreads;
+                size_t last = layer.size() * (t + 1) / numberOfThreads;
+                auto &part = parts[t];
+                int weights[256];
+                for (size_t i = begin; i < last; i++)
+                {
+                    // The weights of the next 256 boards are calculated together:
+                    if (i == begin || (i & 255) == 0)
+                    {
+                        if (timeout == true || watchdog.isExpired() == true)
+                        {
+                            timeout = true;
+                            return;
+                        }
+                        st.boardWeights(&layer[i], min(last - i, 256 - (i & 255)), weights + (i & 255));
+                    }
+                    // The weight of a child is updated with the three holes of its jump:
+                    int weight = weights[i & 255];
+                    for (auto &jump : st.jumps)
+                    {
+                        if ((layer[i] & jump.mask) != jump.pegs)
+                            continue;
+                        auto child = layer[i] ^ jump.mask;
+                        if (pruning.isPruned(child) == false)
+                            part.push_back({weight + jump.weightChange, symmetry.canonical(child)});
+                    }
+                }
+                selectBest(part); });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        if (timeout == true)
+            return false;
+        vector<pair<int, Bitboard>> boards;
+        for (auto &part : parts)
+        {
+            boards.insert(boards.end(), part.begin(), part.end());
+        }
+        selectBest(boards);
+        for (auto &board : boards)
+        {
+            next.push_back(board.second);
+        }
+        sort(next.begin(), next.end());
+        return true;
+    }
+};
+
+/*
+ * The counts do not fit to 64 bits on the bigger boards:
+ */
+typedef unsigned __int128 Count;
+
+string countToString(Count count)
+{
+    string digits;
+    do
+    {
+        digits += char('0' + count % 10);
+        count /= 10;
+    } while (count != 0);
+    return string(digits.rbegin(), digits.rend());
+}
+
+/*
+ * Solve_Count counts all of the solutions instead of finding one. The
+ * forward layers have every reachable canonical board. Then the layers
+ * are walked back from the goal, and the number of the solutions of a
+ * board is the sum of the numbers of its children, found by a binary
+ * search in the next layer. A board and its symmetric boards have the
+ * same number, since the symmetries keep the goal hole in its place. Only
+ * the boards that have a solution are kept for the previous layer, so the
+ * lookups get faster, and the threads share the boards of every layer.
+ */
+class Solve_Count : public Solve_LayeredBFS
+{
+public:
+    Count numberOfSolutions = 0;
+
+    // The forward layers are not pruned, so they have all of the reachable boards:
+    Solve_Count(double timeLimit, int numberOfThreads)
+        : Solve_LayeredBFS(timeLimit, numberOfThreads, "Solution Counting")
+    {
+        isPruningLayers = false;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        layers.push_back({symmetry.canonical(st.board)});
+        long storedNodes = 1;
+        while (stop == false && countPegs(layers.back()[0]) > 1)
+        {
+            vector<Bitboard> next;
+            if (expandLayer(layers.back(), next) == false)
+                stop = true;
+            numberOfExpandedNodes += layers.back().size();
+            if (stop == true || next.empty() == true)
+                break;
+            storedNodes += next.size();
+            maxNumberOfStoredNodes = max(static_cast<int>(storedNodes), maxNumberOfStoredNodes);
+            layers.push_back(move(next));
+            if (governor.isOverBudget() == true)
+            {
+                stop = true;
+                maxScore = -1;
+            }
+        }
+        if (stop == true)
+        {
+            std::cout << "Solutions are not counted - the forward layers are not completed." << endl;
+            return;
+        }
+        countSolutions();
+        if (stop == true)
+            return;
+        checkBestLayer();
+        recoverBestPath();
+    }
+
+    /*
+     * The solvable boards of the next layer and their numbers of solutions
+     * are enough to count the solutions of a layer:
+     */
+    void countSolutions()
+    {
+        vector<Bitboard> solvable;
+        vector<Count> counts;
+        if (binary_search(layers.back().begin(), layers.back().end(), symmetry.canonical(st.goal)) == true)
+        {
+            solvable.push_back(symmetry.canonical(st.goal));
+            counts.push_back(1);
+        }
+        vector<string> rows;
+        rows.push_back(countRow(layers.back(), solvable));
+
+        for (int depth = layers.size() - 2; depth >= 0 && solvable.empty() == false; depth--)
+        {
+            auto &layer = layers[depth];
+            vector<Count> layerCounts(layer.size(), 0);
+            atomic<bool> timeout{false};
+            vector<thread> threads;
+            for (int t = 0; t < numberOfThreads; t++)
+            {
+                threads.emplace_back([&, t]()
+                                     {
+                    size_t begin = layer.size() * t / numberOfThreads;
+                    size_t last = layer.size() * (t + 1) / numberOfThreads;
+                    for (size_t i = begin; i < last; i++)
+                    {
+                        if ((i & 4095) == 0 && (timeout == true || watchdog.isExpired() == true))
+                        {
+                            timeout = true;
+                            return;
+                        }
+                        if (pruning.isPruned(layer[i]) == true)
+                            continue;
+                        for (auto &jump : st.jumps)
+                        {
+                            if ((layer[i] & jump.mask) != jump.pegs)
+                                continue;
+                            auto child = symmetry.canonical(layer[i] ^ jump.mask);
+                            auto found = lower_bound(solvable.begin(), solvable.end(), child);
+                            if (found != solvable.end() && *found == child)
+                                layerCounts[i] += counts[found - solvable.begin()];
+                        }
+                    } });
+            }
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+            if (timeout == true)
+            {
+                stop = true;
+                std::cout << "Solutions are not counted - Time Limit" << endl;
+                return;
+            }
+
+            solvable.clear();
+            counts.clear();
+            for (size_t i = 0; i < layer.size(); i++)
+            {
+                if (layerCounts[i] == 0)
+                    continue;
+                solvable.push_back(layer[i]);
+                counts.push_back(layerCounts[i]);
+            }
+            rows.push_back(countRow(layer, solvable));
+        }
+        numberOfSolutions = counts.empty() == true ? 0 : counts[0];
+
+        std::cout << "Pegs | Reachable boards | Solvable boards | Solvable canonical boards" << endl;
+        for (auto row = rows.rbegin(); row != rows.rend(); row++)
+        {
+            std::cout << *row << endl;
+        }
+        std::cout << "Number of solutions: " << countToString(numberOfSolutions) << endl;
+    }
+
+    // The numbers of the boards of a layer, with all of their symmetric boards:
+    string countRow(vector<Bitboard> &layer, vector<Bitboard> &solvable)
+    {
+        long reachable = 0;
+        long solvableBoards = 0;
+        for (auto board : layer)
+        {
+            reachable += symmetry.orbitSize(board);
+        }
+        for (auto board : solvable)
+        {
+            solvableBoards += symmetry.orbitSize(board);
+        }
+        return to_string(countPegs(layer[0])) + " | " + to_string(reachable) + " | " +
+               to_string(solvableBoards) + " | " + to_string(solvable.size());
+    }
+};
+
+/*
+ * The messages between the processes of the sharded search. The boards of
+ * a BOARDS message follow its header, the other messages are a header.
+ */
+enum ShardMessageType : uint32_t
+{
+    // Coordinator to worker: expand the last layer:
+    EXPAND_LAYER,
+    // Worker to worker: count children that the receiver owns:
+    BOARDS,
+    // Worker to worker: the last batch of the layer is sent:
+    END_OF_LAYER,
+    // Worker to coordinator: the size and the flags of its part of the new layer:
+    LAYER_DONE,
+    // Coordinator to worker: is the board in the layer count:
+    QUERY,
+    ANSWER,
+    STOP_WORKER
+};
+
+// The flags of LAYER_DONE:
+#define LAYER_COMPLETE 1
+#define LAYER_HAS_GOAL 2
+#define LAYER_OVER_BUDGET 4
+
+struct ShardMessage
+{
+    uint32_t type = 0;
+    uint32_t count = 0;
+    Bitboard board = 0;
+    long value = 0;
+    long extra = 0;
+    // The memory of the layers of a worker:
+    size_t bytes = 0;
+    // The boards that a worker has pruned in the layer, by rule:
+    long pruned[NUMBER_OF_PRUNING_RULES] = {0};
+};
+
+/*
+ * ShardChannel is one end of a Unix stream socket between two processes.
+ * A call returns after the whole buffer is sent or read, and false if the
+ * other end is closed. A closed socket does not raise SIGPIPE, so the
+ * coordinator outlives a failed worker.
+ */
+class ShardChannel
+{
+public:
+    int fd = -1;
+
+    bool write(const void *data, size_t size)
+    {
+        auto bytes = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            auto sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent <= 0)
+                return false;
+            bytes += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    bool read(void *data, size_t size)
+    {
+        auto bytes = static_cast<char *>(data);
+        while (size > 0)
+        {
+            auto received = ::read(fd, bytes, size);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            bytes += received;
+            size -= received;
+        }
+        return true;
+    }
+
+    bool send(ShardMessage message)
+    {
+        return write(&message, sizeof(message));
+    }
+
+    bool receive(ShardMessage &message)
+    {
+        return read(&message, sizeof(message));
+    }
+
+    bool sendBoards(vector<Bitboard> &boards)
+    {
+        ShardMessage message;
+        message.type = BOARDS;
+        message.count = boards.size();
+        return send(message) && write(boards.data(), boards.size() * sizeof(Bitboard));
+    }
+
+    void close()
+    {
+        if (fd != -1)
+            ::close(fd);
+        fd = -1;
+    }
+};
+
+/*
+ * Solve_Sharded is the layered breadth-first search over worker processes,
+ * so a search can use the memory of many processes. Every worker owns the
+ * canonical boards of a hash partition: it expands its part of a layer and
+ * sends every child to its owner in batches of SHARD_BATCH_BOARDS boards
+ * over Unix sockets. A receiver thread for every other worker collects the
+ * children that it owns meanwhile, so no worker blocks on a full socket.
+ * A worker sends END_OF_LAYER to every other worker after its last batch,
+ * so its part of the next layer is complete when all of the others have
+ * sent it. This process is the coordinator: it starts a layer when every
+ * worker has reported the previous one, so the search terminates when a
+ * layer is empty, has the goal or is not completed in time. The path is
+ * recovered by asking the owners of the parent boards. The workers are
+ * forked, so all of them can run on one machine.
+ */
+class Solve_Sharded : public Solver
+{
+    vector<ShardChannel> channels;
+    vector<pid_t> workers;
+
+public:
+    int numberOfShards = 1;
+    // The number of the boards of every layer in all of the shards:
+    vector<long> layerSizes;
+
+    Solve_Sharded(double timeLimit, int numberOfShards) : Solver(timeLimit)
+    {
+        this->numberOfShards = max(numberOfShards, 1);
+        std::cout << "Search Method: Sharded Layered Breadth First Search with " << this->numberOfShards
+                  << " worker processes, Time Limit: " << timeLimit << " minutes." << endl;
+    }
+
+    // The symmetric boards have the same canonical board, so they have the same owner:
+    int owner(Bitboard board)
+    {
+        return ((board * 0x9E3779B97F4A7C15ULL) >> 32) % numberOfShards;
+    }
+
+    void run(std::chrono::steady_clock::time_point end)
+    {
+        if (startWorkers(end) == true)
+        {
+            coordinate();
+            if (maxScore > 0)
+                recoverBestPath();
+        }
+        stopWorkers();
+    }
+
+    /*
+     * Every worker has a socket to the coordinator and one to every other
+     * worker. A forked worker closes the ends of the others, so a closed
+     * socket always means that its process has stopped:
+     */
+    bool startWorkers(std::chrono::steady_clock::time_point end)
+    {
+        vector<ShardChannel> workerEnds(numberOfShards);
+        vector<vector<ShardChannel>> peers(numberOfShards, vector<ShardChannel>(numberOfShards));
+        channels.resize(numberOfShards);
+        bool isCreated = true;
+        for (int i = 0; i < numberOfShards; i++)
+        {
+            int fds[2];
+            isCreated = isCreated && socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0;
+            channels[i].fd = isCreated ? fds[0] : -1;
+            workerEnds[i].fd = isCreated ? fds[1] : -1;
+            for (int j = i + 1; j < numberOfShards; j++)
+            {
+                isCreated = isCreated && socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0;
+                peers[i][j].fd = isCreated ? fds[0] : -1;
+                peers[j][i].fd = isCreated ? fds[1] : -1;
+            }
+        }
+        // The buffered output would be written again by the workers:
+        cout.flush();
+        for (int i = 0; i < numberOfShards && isCreated == true; i++)
+        {
+            pid_t pid = fork();
+            if (pid == -1)
+            {
+                isCreated = false;
+                break;
+            }
+            if (pid == 0)
+            {
+                for (int k = 0; k < numberOfShards; k++)
+                {
+                    channels[k].close();
+                    if (k == i)
+                        continue;
+                    workerEnds[k].close();
+                    for (auto &peer : peers[k])
+                    {
+                        peer.close();
+                    }
+                }
+                work(i, workerEnds[i], peers[i], end);
+                // The worker has none of the threads of the coordinator to join:
+                _exit(0);
+            }
+            workers.push_back(pid);
+        }
+        for (int i = 0; i < numberOfShards; i++)
+        {
+            workerEnds[i].close();
+            for (auto &peer : peers[i])
+            {
+                peer.close();
+            }
+        }
+        if (isCreated == false)
+            cerr << "Worker processes of the sharded search cannot be started." << endl;
+        return isCreated;
+    }
+
+    void stopWorkers()
+    {
+        ShardMessage message;
+        message.type = STOP_WORKER;
+        for (auto &channel : channels)
+        {
+            channel.send(message);
+            channel.close();
+        }
+        for (auto pid : workers)
+        {
+            waitpid(pid, nullptr, 0);
+        }
+        workers.clear();
+    }
+
+    /*
+     * The coordinator expands the layers one by one. The best node of a
+     * layer is any of its boards, or the goal if a worker owns it:
+     */
+    void coordinate()
+    {
+        layerSizes = {1};
+        long storedNodes = 1;
+        maxNumberOfStoredNodes = 1;
+        bestNode = createRoot();
+        maxScore = 1;
+        if (isOptimal(bestNode) == true)
+            return;
+        while (watchdog.isExpired() == false && layerSizes.size() != depthLimit)
+        {
+            ShardMessage message;
+            message.type = EXPAND_LAYER;
+            for (auto &channel : channels)
+            {
+                channel.send(message);
+            }
+            long size = 0;
+            long children = 0;
+            size_t bytes = 0;
+            bool isComplete = true;
+            uint32_t flags = 0;
+            Bitboard board = 0;
+            for (auto &channel : channels)
+            {
+                if (channel.receive(message) == false || message.type != LAYER_DONE)
+                {
+                    cerr << "A worker process of the sharded search has stopped." << endl;
+                    return;
+                }
+                size += message.value;
+                children += message.extra;
+                bytes += message.bytes;
+                for (int rule = 0; rule < NUMBER_OF_PRUNING_RULES; rule++)
+                {
+                    pruning.numberOfPrunedNodes[rule] += message.pruned[rule];
+                }
+                isComplete = isComplete && (message.count & LAYER_COMPLETE) != 0;
+                flags |= message.count;
+                if (message.value > 0 && board == 0)
+                    board = message.board;
+            }
+            // The memory of all of the shards, every worker has the budget on its own:
+            governor.update(bytes);
+            if ((flags & LAYER_OVER_BUDGET) != 0)
+            {
+                maxScore = -1;
+                return;
+            }
+            if (isComplete == false)
+                return;
+            numberOfExpandedNodes += layerSizes.back();
+            telemetry.publish(numberOfExpandedNodes, size, layerSizes.size());
+            if (size == 0)
+                return;
+            table.counters.probes += children;
+            table.counters.hits += children - size;
+            layerSizes.push_back(size);
+            storedNodes += size;
+            maxNumberOfStoredNodes = max(maxNumberOfStoredNodes, static_cast<int>(min<long>(storedNodes, INT32_MAX)));
+            maxScore = layerSizes.size();
+            bestNode = Node((flags & LAYER_HAS_GOAL) != 0 ? st.goal : board);
+            bestNode.score = maxScore;
+            if ((flags & LAYER_HAS_GOAL) != 0)
+                return;
+        }
+    }
+
+    /*
+     * Walks back from the best board like the layered search. A parent is
+     * in the previous layer if its owner has it:
+     */
+    void recoverBestPath()
+    {
+        vector<Bitboard> chain = {symmetry.canonical(bestNode.board)};
+        for (int depth = maxScore - 1; depth > 0; depth--)
+        {
+            auto board = chain.back();
+            for (auto &jump : st.jumps)
+            {
+                if ((board & jump.mask) != cellMask(jump.to))
+                    continue;
+                ShardMessage message;
+                message.type = QUERY;
+                message.count = depth - 1;
+                message.board = symmetry.canonical(board ^ jump.mask);
+                auto &channel = channels[owner(message.board)];
+                if (channel.send(message) == false || channel.receive(message) == false)
+                    return;
+                if (message.count == 1)
+                {
+                    chain.push_back(message.board);
+                    break;
+                }
+            }
+        }
+        reverse(chain.begin(), chain.end());
+        bestPath = replayCanonicalPath(chain);
+        bestNode.board = st.board;
+        for (auto jump : bestPath)
+        {
+            bestNode.board ^= st.jumps[jump].mask;
+        }
+    }
+
+    /*
+     * The loop of a worker process. It keeps the sorted layers of its own
+     * boards and answers the messages of the coordinator until it is stopped:
+     */
+    void work(int id, ShardChannel &coordinator, vector<ShardChannel> &peers, std::chrono::steady_clock::time_point end)
+    {
+        // The watchdog of the coordinator is not forked, so a worker has its own clock:
+        Watchdog clock;
+        clock.progressInterval = 0;
+        clock.start(end, telemetry, checkpoints);
+        vector<vector<Bitboard>> layers(1);
+        Bitboard root = symmetry.canonical(st.board);
+        if (owner(root) == id)
+            layers[0].push_back(root);
+        size_t bytes = 0;
+        ShardMessage message;
+        while (coordinator.receive(message) == true)
+        {
+            if (message.type == QUERY)
+            {
+                auto &layer = layers[min<size_t>(message.count, layers.size() - 1)];
+                message.type = ANSWER;
+                message.count = binary_search(layer.begin(), layer.end(), message.board);
+                coordinator.send(message);
+                continue;
+            }
+            if (message.type != EXPAND_LAYER)
+                return;
+
+            vector<vector<Bitboard>> received(numberOfShards);
+            vector<thread> receivers;
+            for (int peer = 0; peer < numberOfShards; peer++)
+            {
+                if (peer == id)
+                    continue;
+                receivers.emplace_back([&, peer]()
+                                       {
+                    ShardMessage batch;
+                    auto &boards = received[peer];
+                    while (peers[peer].receive(batch) == true && batch.type == BOARDS)
+                    {
+                        size_t size = boards.size();
+                        boards.resize(size + batch.count);
+                        if (peers[peer].read(boards.data() + size, batch.count * sizeof(Bitboard)) == false)
+                            return;
+                    } });
+            }
+
+            auto &layer = layers.back();
+            vector<vector<Bitboard>> outgoing(numberOfShards);
+            uint32_t flags = LAYER_COMPLETE;
+            long children = 0;
+            for (size_t i = 0; i < layer.size(); i++)
+            {
+                if (clock.isExpired() == true)
+                {
+                    flags = 0;
+                    break;
+                }
+                if (pruning.isPruned(layer[i]) == true)
+                    continue;
+                for (auto &jump : st.jumps)
+                {
+                    if ((layer[i] & jump.mask) != jump.pegs)
+                        continue;
+                    auto child = symmetry.canonical(layer[i] ^ jump.mask);
+                    int k = owner(child);
+                    children++;
+                    if (k == id)
+                    {
+                        received[id].push_back(child);
+                        continue;
+                    }
+                    outgoing[k].push_back(child);
+                    if (outgoing[k].size() == SHARD_BATCH_BOARDS)
+                    {
+                        peers[k].sendBoards(outgoing[k]);
+                        outgoing[k].clear();
+                    }
+                }
+            }
+            ShardMessage last;
+            last.type = END_OF_LAYER;
+            for (int k = 0; k < numberOfShards; k++)
+            {
+                if (k == id)
+                    continue;
+                if (outgoing[k].empty() == false)
+                    peers[k].sendBoards(outgoing[k]);
+                peers[k].send(last);
+            }
+            for (auto &t : receivers)
+            {
+                t.join();
+            }
+            message.type = LAYER_DONE;
+            message.bytes = bytes;
+            for (int rule = 0; rule < NUMBER_OF_PRUNING_RULES; rule++)
+            {
+                message.pruned[rule] = pruning.numberOfPrunedNodes[rule].exchange(0);
+            }
+            // A part of a layer is not used, the coordinator stops the search:
+            if (flags == 0)
+            {
+                message.count = flags;
+                coordinator.send(message);
+                continue;
+            }
+
+            vector<Bitboard> next;
+            for (auto &boards : received)
+            {
+                next.insert(next.end(), boards.begin(), boards.end());
+                vector<Bitboard>().swap(boards);
+            }
+            vector<Bitboard> buffer;
+            radixSort(next, buffer, st.numberOfHoles);
+            next.erase(unique(next.begin(), next.end()), next.end());
+            next.shrink_to_fit();
+            bytes += next.capacity() * sizeof(Bitboard);
+            governor.update(bytes);
+            if (governor.isOverBudget() == true)
+                flags |= LAYER_OVER_BUDGET;
+            if (binary_search(next.begin(), next.end(), symmetry.canonical(st.goal)) == true)
+                flags |= LAYER_HAS_GOAL;
+            message.count = flags;
+            message.board = next.empty() ? 0 : next[0];
+            message.value = next.size();
+            message.extra = children;
+            message.bytes = bytes;
+            layers.push_back(move(next));
+            coordinator.send(message);
+        }
+    }
+};
+
+/*
+ * Solve_ParallelDFS runs the depth-first search on many threads. Every
+ * worker searches its own stack and arena, and a worker with an empty
+ * stack steals the bottom node of another worker together with the path
+ * to it. The transposition table is shared, and the first worker that
+ * finds the optimal board stops all of them with the shared stop flag.
+ * When more than one worker finds a board with the best score, the one
+ * with the smallest jump sequence is reported, so that the results of
+ * different runs can be compared with the serial search.
+ */
+class Solve_ParallelDFS : public Solver
+{
+    struct Worker
+    {
+        WorkStealingStack stack;
+        NodeArena arena;
+        shared_ptr<NodeSelection> selection;
+        Node bestNode;
+        vector<uint8_t> bestPath;
+        int maxScore = 0;
+        long numberOfExpandedNodes = 0;
+        int maxNumberOfStoredNodes = 0;
+        long probes = 0;
+        long hits = 0;
+        long replacements = 0;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    atomic<bool> sharedStop{false};
+    atomic<int> idleWorkers{0};
+
+public:
+    int numberOfThreads = 1;
+    SelectionType selectionType;
+
+    Solve_ParallelDFS(double timeLimit, int numberOfThreads, SelectionType selectionType = INDEX_FIRST,
+                      unsigned seed = random_device{}()) : Solver(timeLimit)
+    {
+        this->seed = seed;
+        this->numberOfThreads = max(numberOfThreads, 1);
+        this->selectionType = selectionType;
+        telemetry.addWorkers(this->numberOfThreads);
+        std::cout << "Search Method: Parallel Depth-First Search with " << this->numberOfThreads
+                  << " threads, Time Limit: " << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            workers.push_back(make_unique<Worker>());
+            workers[i]->selection = createSelection(selectionType, seed + i);
+        }
+        table.create(governor.tableMegabytes());
+        workers[0]->stack.push(createRoot());
+        table.insert(symmetry.canonical(st.board));
+
+        vector<thread> threads;
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            threads.emplace_back(&Solve_ParallelDFS::work, this, i);
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        collectResults();
+    }
+
+    void work(int id)
+    {
+        auto &worker = *workers[id];
+        auto &progress = telemetry.workers[id];
+        Children children;
+        while (sharedStop.load(memory_order_relaxed) == false)
+        {
+            Node node;
+            uint32_t index = 0;
+            bool found = false;
+            {
+                lock_guard<mutex> guard(worker.stack.lock);
+                if (worker.stack.empty() == false)
+                {
+                    node = worker.stack.pop_return();
+                    worker.arena.rewind(node.parent == NO_PARENT ? 0 : node.parent + 1);
+                    index = worker.arena.add(node);
+                    found = true;
+                }
+            }
+            if (found == false)
+            {
+                if (findWork(id) == false)
+                    return;
+                continue;
+            }
+            if (watchdog.isExpired() == true)
+            {
+                sharedStop = true;
+                return;
+            }
+
+            if (depthLimit != 0 && node.score > depthLimit)
+                continue;
+
+            worker.numberOfExpandedNodes++;
+            worker.maxNumberOfStoredNodes = max(static_cast<int>(worker.stack.size()), worker.maxNumberOfStoredNodes);
+            progress.publish(worker.numberOfExpandedNodes, worker.stack.size(), node.score);
+            checkWorkerBestNode(worker, node, index);
+            if (pruning.isPruned(node.board) == true)
+                continue;
+
+            progress.enter(MOVE_GENERATION);
+            searchMoves(node, index, children);
+            progress.enter(SELECTION);
+            worker.selection->select(children);
+            progress.enter(BOOKKEEPING);
+            lock_guard<mutex> guard(worker.stack.lock);
+            for (auto &child : children)
+            {
+                bool replaced = false;
+                worker.probes++;
+                bool duplicate = table.visit(symmetry.canonical(child.board), replaced);
+                worker.replacements += replaced;
+                if (duplicate == true)
+                {
+                    worker.hits++;
+                    continue;
+                }
+                worker.stack.push(child);
+            }
+        }
+    }
+
+    /*
+     * An idle worker tries to steal from the others until all of the
+     * workers are idle, which means that the whole tree is searched.
+     * A worker is not counted as idle while it is stealing, so a node
+     * can never be lost between two stacks.
+     */
+    bool findWork(int id)
+    {
+        idleWorkers++;
+        while (sharedStop.load(memory_order_relaxed) == false)
+        {
+            if (idleWorkers.load() == numberOfThreads)
+                return false;
+            for (int i = 1; i < numberOfThreads; i++)
+            {
+                int victim = (id + i) % numberOfThreads;
+                if (workers[victim]->stack.sharedSize.load(memory_order_relaxed) == 0)
+                    continue;
+                idleWorkers--;
+                if (steal(victim, id) == true)
+                    return true;
+                idleWorkers++;
+            }
+            this_thread::yield();
+        }
+        return false;
+    }
+
+    /*
+     * The arena records of the victim are not valid in the thief, so the
+     * path of the stolen node is copied and replayed to the thief's arena.
+     */
+    bool steal(int victim, int id)
+    {
+        Node node;
+        vector<uint8_t> path;
+        {
+            auto &other = *workers[victim];
+            lock_guard<mutex> guard(other.stack.lock);
+            if (other.stack.empty() == true)
+                return false;
+            node = other.stack.steal();
+            if (node.parent != NO_PARENT)
+                path = other.arena.path(node.parent);
+        }
+
+        auto &worker = *workers[id];
+        lock_guard<mutex> guard(worker.stack.lock);
+        worker.arena.clear();
+        if (node.parent != NO_PARENT)
+        {
+            Node ancestor(st.board);
+            uint32_t parent = worker.arena.add(ancestor);
+            for (auto jump : path)
+            {
+                ancestor.board ^= st.jumps[jump].mask;
+                ancestor.parent = parent;
+                ancestor.jump = jump;
+                ancestor.score++;
+                parent = worker.arena.add(ancestor);
+            }
+            node.parent = parent;
+        }
+        worker.stack.push(node);
+        return true;
+    }
+
+    void checkWorkerBestNode(Worker &worker, Node &node, uint32_t index)
+    {
+        if (isOptimal(node))
+        {
+            sharedStop = true;
+        }
+        else if (node.score <= worker.maxScore)
+        {
+            return;
+        }
+        worker.maxScore = node.score;
+        worker.bestNode = node;
+        worker.bestPath = worker.arena.path(index);
+    }
+
+    void collectResults()
+    {
+        size_t bytes = table.bytes();
+        for (auto &worker : workers)
+        {
+            bytes += nodeDequeBytes(worker->maxNumberOfStoredNodes) + worker->arena.bytes();
+        }
+        governor.update(bytes);
+        for (auto &worker : workers)
+        {
+            numberOfExpandedNodes += worker->numberOfExpandedNodes;
+            maxNumberOfStoredNodes += worker->maxNumberOfStoredNodes;
+            table.counters.probes += worker->probes;
+            table.counters.hits += worker->hits;
+            table.counters.replacements += worker->replacements;
+            if (worker->maxScore > maxScore ||
+                (worker->maxScore == maxScore && worker->bestPath < bestPath))
+            {
+                maxScore = worker->maxScore;
+                bestNode = worker->bestNode;
+                bestPath = worker->bestPath;
+            }
+        }
+        stop = sharedStop;
+    }
+};
+
+/*
+ * The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ... is the number of
+ * restart units of the i-th run (i >= 1) of a restarting search.
+ */
+long luby(long i)
+{
+    int k = 1;
+    while ((1L << k) - 1 < i)
+        k++;
+    while ((1L << k) - 1 != i)
+    {
+        i -= (1L << (k - 1)) - 1;
+        k = 1;
+        while ((1L << k) - 1 < i)
+            k++;
+    }
+    return 1L << (k - 1);
+}
+
+/*
+ * The portfolio runs a randomized DFS in every thread. The workers share
+ * only the stop flag: each of them owns its random stream, transposition
+ * table and arena, so the run of a worker only depends on its seed and can
+ * be replayed with one thread and that seed. A worker restarts from the
+ * first board with a cleared table after luby(i) * RESTART_NODES expanded
+ * nodes, and the first worker that finds the optimal board stops the rest.
+ */
+class Solve_Portfolio : public Solver
+{
+    struct Worker
+    {
+        unsigned seed = 0;
+        shared_ptr<NodeSelection> selection;
+        TranspositionTable table{PORTFOLIO_TABLE_MB};
+        NodeArena arena;
+        Node bestNode;
+        vector<uint8_t> bestPath;
+        int maxScore = 0;
+        long numberOfExpandedNodes = 0;
+        int maxNumberOfStoredNodes = 0;
+        int numberOfRestarts = 0;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    atomic<bool> sharedStop{false};
+    atomic<int> winner{-1};
+
+public:
+    int numberOfThreads = 1;
+
+    Solve_Portfolio(double timeLimit, int numberOfThreads, unsigned seed = random_device{}()) : Solver(timeLimit)
+    {
+        this->seed = seed;
+        this->numberOfThreads = max(numberOfThreads, 1);
+        telemetry.addWorkers(this->numberOfThreads);
+        std::cout << "Search Method: Randomized Depth-First Search Portfolio with " << this->numberOfThreads
+                  << " workers, Time Limit: " << timeLimit << " minutes." << endl;
+    }
+
+    void run(std::chrono::steady_clock::time_point)
+    {
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            workers.push_back(make_unique<Worker>());
+            workers[i]->seed = seed + i;
+            workers[i]->selection = make_shared<Random>(seed + i);
+        }
+
+        vector<thread> threads;
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            threads.emplace_back(&Solve_Portfolio::work, this, i);
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        collectResults();
+    }
+
+    void work(int id)
+    {
+        auto &worker = *workers[id];
+        for (long restart = 1; sharedStop.load(memory_order_relaxed) == false; restart++)
+        {
+            if (dive(id, RESTART_NODES * luby(restart)) == true)
+                return;
+            worker.numberOfRestarts++;
+        }
+    }
+
+    /*
+     * Searches from the first board until the budget of expanded nodes is
+     * spent. Returns true when the worker is done, because of the stop flag
+     * or because the whole tree is searched before the budget is spent.
+     */
+    bool dive(int id, long budget)
+    {
+        auto &worker = *workers[id];
+        auto &progress = telemetry.workers[id];
+        Stack s;
+        Children children;
+        worker.table.clear();
+        worker.arena.clear();
+        s.push(createRoot());
+        worker.table.insert(symmetry.canonical(st.board));
+
+        for (long expanded = 0; s.empty() == false; expanded++)
+        {
+            if (expanded == budget)
+                return false;
+            if ((expanded & 1023) == 0 &&
+                (sharedStop.load(memory_order_relaxed) == true || watchdog.isExpired() == true))
+            {
+                sharedStop = true;
+                return true;
+            }
+
+            Node node = s.pop_return();
+            worker.arena.rewind(node.parent == NO_PARENT ? 0 : node.parent + 1);
+            uint32_t index = worker.arena.add(node);
+            if (depthLimit != 0 && node.score > depthLimit)
+                continue;
+
+            worker.numberOfExpandedNodes++;
+            worker.maxNumberOfStoredNodes = max(static_cast<int>(s.size()), worker.maxNumberOfStoredNodes);
+            progress.publish(worker.numberOfExpandedNodes, s.size(), node.score);
+            if (node.score > worker.maxScore || isOptimal(node))
+            {
+                worker.maxScore = node.score;
+                worker.bestNode = node;
+                worker.bestPath = worker.arena.path(index);
+            }
+            if (isOptimal(node))
+            {
+                int none = -1;
+                winner.compare_exchange_strong(none, id);
+                sharedStop = true;
+                return true;
+            }
+            if (pruning.isPruned(node.board) == true)
+                continue;
+
+            progress.enter(MOVE_GENERATION);
+            searchMoves(node, index, children);
+            progress.enter(SELECTION);
+            worker.selection->select(children);
+            progress.enter(BOOKKEEPING);
+            for (auto &child : children)
+            {
+                if (worker.table.insert(symmetry.canonical(child.board)) == false)
+                    s.push(child);
+            }
+        }
+        sharedStop = true;
+        return true;
+    }
+
+    /*
+     * The seeds of all of the workers are logged, and the result is taken
+     * from the winner, or from the deepest worker if nobody has won.
+     */
+    void collectResults()
+    {
+        size_t bytes = table.bytes();
+        int best = winner.load();
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            auto &worker = *workers[i];
+            bytes += worker.table.bytes() + nodeDequeBytes(worker.maxNumberOfStoredNodes) + worker.arena.bytes();
+            numberOfExpandedNodes += worker.numberOfExpandedNodes;
+            maxNumberOfStoredNodes += worker.maxNumberOfStoredNodes;
+            table.counters.probes += worker.table.counters.probes;
+            table.counters.hits += worker.table.counters.hits;
+            table.counters.replacements += worker.table.counters.replacements;
+            if (winner.load() == -1 && worker.maxScore > (best == -1 ? 0 : workers[best]->maxScore))
+                best = i;
+            std::cout << "Worker " << i << ": seed " << worker.seed << ", " << worker.numberOfRestarts
+                      << " restarts, " << worker.numberOfExpandedNodes << " expanded nodes, "
+                      << countPegs(worker.bestNode.board) << " pegs left." << endl;
+        }
+        governor.update(bytes);
+        if (best != -1)
         {
-            auto &node = prioritizedMoves.back().second;
-            counter++;
-            if (counter > prioritizedMoves.size() / 2)
-            {
-                res.push_back(node);
-            }
-            prioritizedMoves.pop_back();
+            maxScore = workers[best]->maxScore;
+            bestNode = workers[best]->bestNode;
+            bestPath = workers[best]->bestPath;
+        }
+        if (winner.load() != -1)
+        {
+            std::cout << "Solved by worker " << best << " after " << workers[best]->numberOfRestarts
+                      << " restarts, replay it with --methods dfsrp --threads 1 --seed "
+                      << workers[best]->seed << endl;
         }
-        return res;
+        stop = sharedStop;
     }
 };
 
 /*
- * Frontier class is a base class for both
- * Queue and Stack which is used by DFS and BFS
- * algorithms. Queue and Stack classes are wrappers
- * around stl queue and stack classes.
+ * Solve class provides time measurement and function
+ * calls to the solver classes.
  */
-class Frontier
-{
-public:
-    virtual bool empty() = 0;
-    virtual size_t size() = 0;
-    virtual void push(shared_ptr<Node> node) = 0;
-    virtual shared_ptr<Node> pop_return() = 0;
-};
-
-class Stack : public Frontier
+class Solve
 {
-    stack<shared_ptr<Node>> s;
-
 public:
-    bool empty()
-    {
-        return s.empty();
-    }
-    size_t size()
-    {
-        return s.size();
-    }
-    void push(shared_ptr<Node> node)
-    {
-        s.push(node);
-    }
-    shared_ptr<Node> pop_return()
+    void start(Solver &s)
     {
-        auto ret = s.top();
-        s.pop();
-        return ret;
+        auto runtime = measure(s);
+        s.printResults(runtime);
     }
-};
 
-class Queue : public Frontier
-{
-    queue<shared_ptr<Node>> q;
-
-public:
-    bool empty()
-    {
-        return q.empty();
-    }
-    size_t size()
+    // Runs the solver and returns its runtime in seconds:
+    double measure(Solver &s)
     {
-        return q.size();
-    }
-    void push(shared_ptr<Node> node)
-    {
-        q.push(node);
-    }
-    shared_ptr<Node> pop_return()
-    {
-        auto ret = q.front();
-        q.pop();
-        return ret;
+        auto start = std::chrono::steady_clock::now();
+        auto begin = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double, ratio<60>>(s.timeLimit));
+#ifdef COUNT_HEAP_ALLOCATIONS
+        long allocations = ::numberOfHeapAllocations.load();
+#endif
+        s.watchdog.start(begin, s.telemetry, s.checkpoints);
+        s.run(begin);
+        s.watchdog.stop();
+#ifdef COUNT_HEAP_ALLOCATIONS
+        s.numberOfHeapAllocations = ::numberOfHeapAllocations.load() - allocations;
+#endif
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
     }
 };
 
 /*
- * Solver class provides a problem solver framework for all 5 methods.
- * It saves best found board, checks if stop condition is raised and the
- * other required things that are mentioned in the homework.
+ * Benchmark class is the command line driver. It runs the selected methods
+ * for a number of repetitions and writes a row for every run, as the
+ * human readable results, as JSON lines or as CSV.
  */
-class Solver
+class Benchmark
 {
 public:
-    SoloTest st;
-    shared_ptr<Node> bestNode = nullptr;
-    int timeLimit = 0;
-    int maxScore = 0;
-    bool stop = false;
-    bool isDepthLimitReached = false;
-    int numberOfExpandedNodes = 0;
-    int maxNumberOfStoredNodes = 0;
+    const vector<string> allMethods = {"dfs", "bfs", "ids", "dfsr", "dfsh", "pdfs", "lbfs", "astar", "idastar", "bidir", "beam", "dfsrp", "count", "memo", "shard"};
+    // Only the original 5 methods are run by default:
+    vector<string> methods = {"dfs", "bfs", "ids", "dfsr", "dfsh"};
+    const Geometry *board = &ENGLISH;
+    double timeLimit = 60;
+    int depthLimit = 0;
+    int repetitions = 1;
+    unsigned seed = random_device{}();
+    int numberOfThreads = max(1u, thread::hardware_concurrency());
+    size_t memoryBudget = MEMORY_BUDGET_MB;
+    int beamWidth = BEAM_WIDTH;
+    int numberOfShards = 2;
+    // The frontiers of bfs and ids are spilled to files of this directory if it is given:
+    string spillDirectory;
+    string checkpointPath;
+    double checkpointInterval = CHECKPOINT_INTERVAL_SECONDS;
+    double progressInterval = PROGRESS_INTERVAL_SECONDS;
+    string resumePath;
+    vector<string> dispatches = {"static"};
+    string format = "text";
+    string solutionFormat = "boards";
+    string outputPath;
+    // The file of the batch jobs, or "vacancies" for every single free hole:
+    string batchPath;
 
-    Solver(int timeLimit)
+    void printUsage()
     {
-        st.createBoard();
-        this->timeLimit = timeLimit;
+        cerr << "Usage: main [options]" << endl
+             << "  --methods m1,m2,...   dfs, bfs, ids, dfsr, dfsh, pdfs, lbfs, astar, idastar, bidir, beam, dfsrp, count, memo, shard (default: dfs,bfs,ids,dfsr,dfsh)" << endl
+             << "  --board BOARD         english, european, wiegleb or triangular (default: english)" << endl
+             << "  --time-limit MINUTES  time limit of every run (default: 60)" << endl
+             << "  --depth-limit DEPTH   nodes deeper than this are not expanded (default: none, all holes for ids)" << endl
+             << "  --repetitions N       number of runs of every method (default: 1)" << endl
+             << "  --seed SEED           seed of the first repetition of the random methods" << endl
+             << "  --threads N           threads of the parallel methods (default: all cores)" << endl
+             << "  --memory-budget MB    memory budget of every run (default: " << MEMORY_BUDGET_MB << ")" << endl
+             << "  --beam-width K        boards kept in every layer of beam (default: " << BEAM_WIDTH << ")" << endl
+             << "  --shards N            worker processes of shard (default: 2)" << endl
+             << "  --spill-dir DIR       directory of the spilled frontier nodes of bfs and ids (default: none, all in memory)" << endl
+             << "  --checkpoint FILE     checkpoint file of dfs, bfs, dfsr and dfsh, written periodically and at the time limit" << endl
+             << "  --checkpoint-interval SECONDS  seconds between the checkpoints (default: " << CHECKPOINT_INTERVAL_SECONDS << ")" << endl
+             << "  --resume FILE         continue the search of the checkpoint file" << endl
+             << "  --progress SECONDS    seconds between the progress lines of the text format, 0 for none (default: " << PROGRESS_INTERVAL_SECONDS << ")" << endl
+             << "  --dispatch MODE       static, virtual or both to run every method with both search loops (default: static)" << endl
+             << "  --batch FILE          solve the start and goal holes of every line of the file on a thread pool," << endl
+             << "                        \"vacancies\" for every single free hole that is also the goal" << endl
+             << "  --format FORMAT       text, json or csv (default: text)" << endl
+             << "  --solution FORMAT     solution of the text format: boards, moves, json or none (default: boards)" << endl
+             << "  --output FILE         file of the rows (default: standard output)" << endl;
     }
 
     /*
-     * This function searches possible moves on a board state and returns them
-     * by assigning their parent node as the given board.
+     * The whole value must be a number between low and high, so "1x" or a
+     * negative number of an unsigned option is a wrong argument:
      */
-    vector<shared_ptr<Node>> searchMoves(shared_ptr<Node> &board)
+    template <typename T>
+    bool parseNumber(const string &value, T low, T high, T &number)
+    {
+        // Infinity and NaN are not numbers of an option, and -Ofast cannot compare them:
+        if (value.find_first_not_of("0123456789+-.eE") != string::npos)
+            return false;
+        size_t length = 0;
+        long double parsed = 0;
+        try
+        {
+            parsed = is_integral<T>::value ? static_cast<long double>(stoll(value, &length)) : stold(value, &length);
+        }
+        catch (const logic_error &)
+        {
+            return false;
+        }
+        if (length != value.size() || parsed < low || parsed > high)
+            return false;
+        number = static_cast<T>(parsed);
+        return true;
+    }
+
+    bool parseArguments(int argc, char **argv)
     {
-        vector<shared_ptr<Node>> nodes;
-        vector<vector<int>> tempBoard = board->board;
-        for (int i = 0; i < board->board.size(); i++)
+        for (int i = 1; i < argc; i++)
         {
-            for (int j = 0; j < board->board[i].size(); j++)
+            string option = argv[i];
+            if (i + 1 >= argc)
+                return false;
+            string value = argv[++i];
+            if (option == "--methods")
             {
-                if (board->board[i][j] == FREE)
+                methods.clear();
+                stringstream list(value);
+                string method;
+                while (getline(list, method, ','))
                 {
-                    for (auto move : st.moves)
-                    {
-                        /*
-                         * Calculating the indexes of a move; it checks
-                         * the previous and the second previous indexes for a correct move.
-                         */
-                        auto first = i + move.first;
-                        auto second = j + move.second;
-                        auto prevFirst = move.first == 0 ? 0 : move.first < 0 ? 1
-                                                                              : -1;
-                        auto prevSecond = move.second == 0 ? 0 : move.second < 0 ? 1
-                                                                                 : -1;
-                        prevFirst += first;
-                        prevSecond += second;
-                        if (first >= 0 && first < tempBoard.size() &&
-                            second >= 0 && second < tempBoard[i].size() &&
-                            tempBoard[first][second] == PEG &&
-                            tempBoard[prevFirst][prevSecond] == PEG)
-                        {
-                            // If all conditions are true, a new board will be constructed:
-                            tempBoard[prevFirst][prevSecond] = FREE;
-                            tempBoard[i][j] = tempBoard[first][second];
-                            tempBoard[first][second] = FREE;
-                            auto node = make_shared<Node>(tempBoard);
-                            tempBoard = board->board;
-                            node->parent = board;
-                            node->score = board->score + 1;
-                            node->lastDeletedPegIndex = make_pair(prevFirst, prevSecond);
-                            nodes.push_back(node);
-                        }
-                    }
+                    methods.push_back(method);
                 }
             }
+            else if (option == "--board")
+            {
+                board = nullptr;
+                for (auto geometry : GEOMETRIES)
+                {
+                    if (value == geometry->name)
+                        board = geometry;
+                }
+                if (board == nullptr)
+                    return false;
+            }
+            else if (option == "--time-limit")
+            {
+                if (parseNumber(value, 0.0, 1e9, timeLimit) == false || timeLimit <= 0)
+                    return false;
+            }
+            else if (option == "--depth-limit")
+            {
+                if (parseNumber(value, 0, MAX_NUMBER_OF_HOLES, depthLimit) == false)
+                    return false;
+            }
+            else if (option == "--repetitions")
+            {
+                if (parseNumber(value, 1, INT32_MAX, repetitions) == false)
+                    return false;
+            }
+            else if (option == "--seed")
+            {
+                if (parseNumber(value, 0u, UINT32_MAX, seed) == false)
+                    return false;
+            }
+            else if (option == "--threads")
+            {
+                if (parseNumber(value, 1, 1024, numberOfThreads) == false)
+                    return false;
+            }
+            else if (option == "--memory-budget")
+            {
+                if (parseNumber(value, size_t(0), size_t(1) << 30, memoryBudget) == false)
+                    return false;
+            }
+            else if (option == "--beam-width")
+            {
+                if (parseNumber(value, 1, INT32_MAX, beamWidth) == false)
+                    return false;
+            }
+            else if (option == "--shards")
+            {
+                if (parseNumber(value, 1, 1024, numberOfShards) == false)
+                    return false;
+            }
+            else if (option == "--spill-dir")
+                spillDirectory = value;
+            else if (option == "--checkpoint")
+                checkpointPath = value;
+            else if (option == "--checkpoint-interval")
+            {
+                if (parseNumber(value, 0.0, 1e9, checkpointInterval) == false || checkpointInterval <= 0)
+                    return false;
+            }
+            else if (option == "--resume")
+                resumePath = value;
+            else if (option == "--progress")
+            {
+                if (parseNumber(value, 0.0, 1e9, progressInterval) == false)
+                    return false;
+            }
+            else if (option == "--dispatch")
+            {
+                if (value != "static" && value != "virtual" && value != "both")
+                    return false;
+                dispatches = value == "both" ? vector<string>{"static", "virtual"} : vector<string>{value};
+            }
+            else if (option == "--format")
+                format = value;
+            else if (option == "--solution")
+            {
+                if (value != "boards" && value != "moves" && value != "json" && value != "none")
+                    return false;
+                solutionFormat = value;
+            }
+            else if (option == "--output")
+                outputPath = value;
+            else if (option == "--batch")
+                batchPath = value;
+            else
+                return false;
         }
-        return nodes;
-    }
-
-    /*
-     * This is the main loop to solve the problem.
-     * All of the 5 methods use the following function:
-     */
-    void solve(Frontier &frontier, std::chrono::steady_clock::time_point end,
-               shared_ptr<NodeSelection> selection, int maxDepth = 0)
-    {
-        // Pushing the first state of the board to the frontier:
-        frontier.push(make_shared<Node>(st.board));
-
-        while (frontier.empty() == false)
+        /*
+         * A checkpoint belongs to a single run, the runs of a batch, of many
+         * methods or of the repetitions would write to the same file. Only the
+         * frontiers of dfs, bfs, dfsr and dfsh can be copied, bfs only in memory:
+         */
+        if (checkpointPath.empty() == false || resumePath.empty() == false)
         {
-            auto currBoard = move(frontier.pop_return());
-
-            checkStopCriterion(frontier, currBoard, end, maxDepth);
-            if (stop == true || isDepthLimitReached == true)
-                return;
-
-            saveProblemStateInfo(frontier, currBoard);
-
-            auto nodes = searchMoves(currBoard);
-            nodes = selection->select(nodes);
-            for (auto &node : nodes)
+            const vector<string> checkpointMethods = {"dfs", "bfs", "dfsr", "dfsh"};
+            if (batchPath.empty() == false || methods.size() != 1 || repetitions != 1 || dispatches.size() != 1)
+            {
+                cerr << "--checkpoint and --resume need a single method, repetition and dispatch without --batch." << endl;
+                return false;
+            }
+            if (find(checkpointMethods.begin(), checkpointMethods.end(), methods[0]) == checkpointMethods.end() ||
+                (methods[0] == "bfs" && spillDirectory.empty() == false))
             {
-                frontier.push(move(node));
+                cerr << "--checkpoint and --resume are only supported by dfs, bfs without --spill-dir, dfsr and dfsh." << endl;
+                return false;
             }
         }
+        for (auto &method : methods)
+        {
+            if (find(allMethods.begin(), allMethods.end(), method) == allMethods.end())
+                return false;
+        }
+        return format == "text" || format == "json" || format == "csv";
     }
 
-    void checkStopCriterion(Frontier &frontier, shared_ptr<Node> node,
-                            std::chrono::steady_clock::time_point end, int maxDepth)
+    unique_ptr<Solver> createSolver(string method, unsigned runSeed, string dispatch, const Geometry &geometry,
+                                    int threads, BoardCache *cache = nullptr)
     {
-        auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - end).count();
-        if (elapsedTime > 0)
-            stop = true;
-
-        // Frontier size: 3231848 frontier nodes equals to approximately 2GB.
-        if (frontier.size() > 3231848)
+        unique_ptr<Solver> solver;
+        if (method == "dfs")
+            solver = make_unique<Solve_DFS>(timeLimit);
+        else if (method == "bfs")
+            solver = make_unique<Solve_BFS>(timeLimit, spillDirectory);
+        else if (method == "ids")
+            solver = make_unique<Solve_IDS>(timeLimit, depthLimit, spillDirectory);
+        else if (method == "dfsr")
+            solver = make_unique<Solve_DFSR>(timeLimit, runSeed);
+        else if (method == "dfsh")
+            solver = make_unique<Solve_DFSH>(timeLimit);
+        else if (method == "pdfs")
+            solver = make_unique<Solve_ParallelDFS>(timeLimit, threads, INDEX_FIRST, runSeed);
+        else if (method == "lbfs")
+            solver = make_unique<Solve_LayeredBFS>(timeLimit, threads);
+        else if (method == "astar")
+            solver = make_unique<Solve_AStar>(timeLimit);
+        else if (method == "bidir")
+            solver = make_unique<Solve_Bidirectional>(timeLimit, threads);
+        else if (method == "beam")
+            solver = make_unique<Solve_Beam>(timeLimit, threads, beamWidth);
+        else if (method == "dfsrp")
+            solver = make_unique<Solve_Portfolio>(timeLimit, threads, runSeed);
+        else if (method == "count")
+            solver = make_unique<Solve_Count>(timeLimit, threads);
+        else if (method == "shard")
+            solver = make_unique<Solve_Sharded>(timeLimit, numberOfShards);
+        else if (method == "memo")
         {
-            stop = true;
-            maxScore = -1;
+            auto memo = make_unique<Solve_Memo>(timeLimit);
+            memo->cache = cache;
+            solver = move(memo);
         }
+        else
+            solver = make_unique<Solve_IDAStar>(timeLimit);
+        if (method != "ids")
+            solver->depthLimit = depthLimit;
+        solver->setBoard(geometry);
+        solver->governor.budget = memoryBudget * 1024 * 1024;
+        solver->checkpoints.path = checkpointPath;
+        solver->checkpoints.interval = checkpointInterval;
+        solver->resumePath = resumePath;
+        solver->method = method;
+        solver->isVirtualDispatch = dispatch == "virtual";
+        // The text output of the JSON and CSV formats is discarded, the watchdog would write to a stream without a buffer:
+        solver->watchdog.progressInterval = format == "text" ? progressInterval : 0;
+        solver->solutionFormat = solutionFormat;
+        return solver;
+    }
 
-        if (maxDepth != 0 && node->score > maxDepth)
-            isDepthLimitReached = true;
+    string resultQuality(Solver &s)
+    {
+        if (s.maxScore == -1)
+            return "out_of_memory";
+        if (s.maxScore == 0)
+            return "no_solution";
+        if (s.isOptimal(s.bestNode))
+            return "optimal";
+        return "suboptimal";
     }
 
-    void saveProblemStateInfo(Frontier &frontier, shared_ptr<Node> node)
+    // The free holes of the initial board:
+    string freeHoles(Solver &s)
     {
-        numberOfExpandedNodes++;
-        maxNumberOfStoredNodes = max(static_cast<int>(frontier.size()), maxNumberOfStoredNodes);
-        checkBestNode(node);
+        string holes;
+        for (int hole = 0; hole < s.st.numberOfHoles; hole++)
+        {
+            if ((s.st.board & cellMask(hole)) == 0)
+                holes += (holes.empty() ? "" : " ") + cellName(*s.st.geometry, hole);
+        }
+        return holes;
     }
 
-    void checkBestNode(shared_ptr<Node> &node)
+    void writeRow(ostream &out, string method, string dispatch, int repetition, unsigned runSeed, Solver &s, double runtime)
     {
-        if (node->board[3][3] == PEG && 33 - node->score == 1)
+        double nodesPerSecond = runtime > 0 ? s.numberOfExpandedNodes / runtime : 0;
+        int remainingPegs = s.maxScore > 0 ? countPegs(s.bestNode.board) : -1;
+        string start = freeHoles(s);
+        string goal = cellName(*s.st.geometry, s.st.geometry->goalHole);
+        if (format == "json")
         {
-            maxScore = node->score;
-            stop = true;
-            bestNode = node;
+            out << "{\"method\":\"" << method << "\",\"board\":\"" << board->name
+                << "\",\"start\":\"" << start << "\",\"goal\":\"" << goal
+                << "\",\"dispatch\":\"" << dispatch
+                << "\",\"repetition\":" << repetition
+                << ",\"seed\":" << runSeed << ",\"threads\":" << numberOfThreads
+                << ",\"time_limit_minutes\":" << timeLimit << ",\"depth_limit\":" << depthLimit
+                << ",\"runtime_seconds\":" << runtime << ",\"expanded_nodes\":" << s.numberOfExpandedNodes
+                << ",\"nodes_per_second\":" << nodesPerSecond
+                << ",\"max_stored_nodes\":" << s.maxNumberOfStoredNodes
+                << ",\"peak_bytes\":" << s.governor.peakBytes << ",\"max_score\":" << s.maxScore
+                << ",\"remaining_pegs\":" << remainingPegs << ",\"result\":\"" << resultQuality(s) << "\""
+                << ",\"table_hit_rate\":" << s.table.counters.hitRate()
+                << ",\"verified\":" << (s.verifySolution() ? "true" : "false")
+                << ",\"moves\":" << s.movesToJson() << "}" << '\n';
         }
-        else if (node->score > maxScore)
+        else
         {
-            maxScore = node->score;
-            bestNode = node;
+            out << method << ',' << board->name << ',' << start << ',' << goal << ',' << dispatch << ',' << repetition << ',' << runSeed << ',' << numberOfThreads << ','
+                << timeLimit << ',' << depthLimit << ',' << runtime << ',' << s.numberOfExpandedNodes << ','
+                << nodesPerSecond << ',' << s.maxNumberOfStoredNodes << ',' << s.governor.peakBytes << ','
+                << s.maxScore << ',' << remainingPegs << ',' << resultQuality(s) << ','
+                << s.table.counters.hitRate() << ',' << (s.verifySolution() ? "true" : "false") << ','
+                << s.movesToString() << '\n';
         }
+        out.flush();
     }
 
-    void printResults(long runtime)
+    /*
+     * In the JSON and CSV formats the human readable output of the solvers
+     * is discarded, so that the rows can be written to the standard output.
+     */
+    bool run()
     {
-        if (maxScore == 0 || bestNode == nullptr)
+        ofstream file;
+        if (outputPath.empty() == false)
         {
-            cout << "No solution found - Time Limit" << endl;
+            file.open(outputPath);
+            if (file.is_open() == false)
+            {
+                cerr << "Output file " << outputPath << " cannot be written." << endl;
+                return false;
+            }
         }
-        else if (maxScore == -1)
+        ostream out(outputPath.empty() ? cout.rdbuf() : file.rdbuf());
+        auto textBuffer = cout.rdbuf();
+        if (format != "text" || batchPath.empty() == false)
+            cout.rdbuf(nullptr);
+        if (format == "csv")
         {
-            cout << "No solution found - Out of Memory" << endl;
-            printStates(bestNode);
+            out << "method,board,start,goal,dispatch,repetition,seed,threads,time_limit_minutes,depth_limit,runtime_seconds,"
+                << "expanded_nodes,nodes_per_second,max_stored_nodes,peak_bytes,max_score,"
+                << "remaining_pegs,result,table_hit_rate,verified,moves" << '\n';
         }
-        else if (bestNode->board[3][3] == PEG && 33 - maxScore == 1)
+
+        if (batchPath.empty() == false)
         {
-            cout << "Optimum solution found." << endl;
-            printStates(bestNode);
+            runBatch(out);
+            cout.rdbuf(textBuffer);
+            cout.clear();
+            return out.flush().good();
         }
-        else if (bestNode->board[3][3] == FREE || 33 - maxScore != 1)
+
+        Solve solve;
+        for (int repetition = 0; repetition < repetitions; repetition++)
         {
-            cout << "Sub-optimum Solution Found with " << 33 - maxScore << " remaining pegs." << endl;
-            printStates(bestNode);
+            for (auto &method : methods)
+            {
+                for (auto &dispatch : dispatches)
+                {
+                    unsigned runSeed = seed + repetition;
+                    auto solver = createSolver(method, runSeed, dispatch, *board, numberOfThreads);
+                    auto runtime = solve.measure(*solver);
+                    if (format == "text")
+                        solver->printResults(runtime);
+                    else
+                        writeRow(out, method, dispatch, repetition, runSeed, *solver, runtime);
+                }
+            }
         }
-        std::cout << "Runtime: " << (double)runtime / 60 << " minutes." << std::endl;
-        std::cout << "Number of expanded nodes: " << numberOfExpandedNodes << endl;
-        std::cout << "Max number of nodes stored in the memory: " << maxNumberOfStoredNodes << endl;
-        cout << endl;
+        cout.rdbuf(textBuffer);
+        cout.clear();
+        // A row that cannot be written, like on a full disk, fails the run:
+        return out.flush().good();
     }
 
-    void printStates(shared_ptr<Node> &node)
+    /*
+     * Every line of the batch file has a start hole and a goal hole, like
+     * "a3 d4". A single hole is both of them and # starts a comment:
+     */
+    bool readJobs(vector<Geometry> &problems)
     {
-        cout << "Board states:" << endl;
-        stack<vector<vector<int>>> states;
-        while (node != nullptr)
+        if (batchPath == "vacancies")
+        {
+            for (int hole = 0; hole < board->numberOfHoles; hole++)
+            {
+                problems.push_back(createProblem(*board, hole, hole));
+            }
+            return true;
+        }
+        ifstream file(batchPath);
+        if (file.is_open() == false)
         {
-            states.push(node->board);
-            node = node->parent;
+            cerr << "Batch file " << batchPath << " cannot be read." << endl;
+            return false;
         }
-        int counter = 0;
-        while (states.empty() == false)
+        string line;
+        for (int number = 1; getline(file, line); number++)
         {
-            cout << counter++ << ". State: " << endl;
-            printBoard(states.top());
-            states.pop();
+            stringstream words(line.substr(0, line.find('#')));
+            string start, goal;
+            if (!(words >> start))
+                continue;
+            if (!(words >> goal))
+                goal = start;
+            int startHole = parseCell(*board, start);
+            int goalHole = parseCell(*board, goal);
+            if (startHole == -1 || goalHole == -1)
+            {
+                cerr << "Line " << number << " of " << batchPath << " is not a pair of holes of the "
+                     << board->name << " board." << endl;
+                return false;
+            }
+            problems.push_back(createProblem(*board, startHole, goalHole));
         }
+        return true;
     }
 
-    void printBoard(vector<vector<int>> &board)
+    /*
+     * Runs every method on every job of the batch file. The runs are
+     * scheduled on a pool of threads, each run has a single thread, and
+     * a row is written as soon as a run finishes, so the rows are in the
+     * order of the finished runs. The memo solvers share a BoardCache.
+     */
+    void runBatch(ostream &out)
     {
-        for (int i = 0; i < board.size(); i++)
+        vector<Geometry> problems;
+        if (readJobs(problems) == false)
+            return;
+        struct Task
+        {
+            int job;
+            string method;
+            string dispatch;
+            int repetition;
+        };
+        vector<Task> tasks;
+        for (int repetition = 0; repetition < repetitions; repetition++)
         {
-            for (int j = 0; j < board[i].size(); j++)
+            for (int job = 0; job < problems.size(); job++)
             {
-                string c;
-                if (board[i][j] == FREE)
+                for (auto &method : methods)
                 {
-                    c = '.';
+                    for (auto &dispatch : dispatches)
+                    {
+                        tasks.push_back({job, method, dispatch, repetition});
+                    }
                 }
-                else if (board[i][j] == WALL)
+            }
+        }
+
+        BoardCache cache(*board);
+        atomic<size_t> nextTask{0};
+        mutex outputLock;
+        auto work = [&]()
+        {
+            Solve solve;
+            for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+            {
+                auto &task = tasks[i];
+                unsigned runSeed = seed + task.repetition;
+                unique_ptr<Solver> solver;
                 {
-                    c = ' ';
+                    // The constructors write to cout:
+                    lock_guard<mutex> guard(outputLock);
+                    solver = createSolver(task.method, runSeed, task.dispatch, problems[task.job], 1, &cache);
                 }
-                else
+                solver->watchdog.progressInterval = 0;
+                auto runtime = solve.measure(*solver);
+                // The count of the process includes the allocations of the other jobs:
+                if (numberOfThreads > 1)
+                    solver->numberOfHeapAllocations = -1;
+                lock_guard<mutex> guard(outputLock);
+                if (format == "text")
                 {
-                    c = 'O';
+                    ostringstream text;
+                    text << "Job " << task.job << ": " << freeHoles(*solver) << " to "
+                         << cellName(problems[task.job], problems[task.job].goalHole) << ", " << task.method
+                         << ": " << resultQuality(*solver) << ", " << solver->bestPath.size() << " jumps, "
+                         << solver->numberOfExpandedNodes << " expanded nodes, " << runtime << " seconds.\n";
+                    if (solver->maxScore > 0)
+                        solver->writeSolution(text);
+                    out << text.str() << flush;
                 }
-                cout << c;
+                else
+                    writeRow(out, task.method, task.dispatch, task.repetition, runSeed, *solver, runtime);
             }
-            cout << endl;
-        }
-        cout << endl;
-    }
-
-    virtual void run(std::chrono::steady_clock::time_point timeLimit) = 0;
-};
-
-class Solve_DFS : public Solver
-{
-public:
-    Solve_DFS(int timeLimit) : Solver(timeLimit)
-    {
-        std::cout << "Search Method: Depth-First Search, Time Limit: "
-                  << timeLimit << " minutes." << endl;
-    }
-
-    void run(std::chrono::steady_clock::time_point end)
-    {
-        Stack s;
-        shared_ptr<NodeSelection> selection = make_shared<IndexFirst>();
-        solve(s, end, selection);
-    }
-};
-
-class Solve_BFS : public Solver
-{
-public:
-    Solve_BFS(int timeLimit) : Solver(timeLimit)
-    {
-        std::cout << "Search Method: Breadth First Search, Time Limit: "
-                  << timeLimit << " minutes." << endl;
-    }
-
-    void run(std::chrono::steady_clock::time_point end)
-    {
-        Queue q;
-        shared_ptr<NodeSelection> selection = make_shared<IndexFirst>();
-        solve(q, end, selection);
-    }
-};
-
-class Solve_IDS : public Solver
-{
-public:
-    int depthLimit = 0;
-    Solve_IDS(int timeLimit, int depthLimit) : Solver(timeLimit)
-    {
-        std::cout << "Search Method: Iterative Deepening Search, Time Limit: "
-                  << timeLimit << " minutes." << endl;
-        this->depthLimit = depthLimit;
-    }
-
-    void cleanStack(Stack s)
-    {
-        while (s.empty() == false)
+        };
+        vector<thread> threads;
+        for (int i = 0; i < min<size_t>(numberOfThreads, tasks.size()); i++)
         {
-            s.pop_return();
+            threads.emplace_back(work);
         }
-    }
-
-    void run(std::chrono::steady_clock::time_point end)
-    {
-        shared_ptr<NodeSelection> selection = make_shared<IndexFirst>();
-        for (int i = 1; i <= depthLimit; i++)
+        for (auto &t : threads)
         {
-            isDepthLimitReached = false;
-            Stack s;
-            solve(s, end, selection, i);
-            if (stop == true)
-                return;
-            cleanStack(s);
+            t.join();
         }
     }
 };
 
-class Solve_DFSR : public Solver
-{
-public:
-    Solve_DFSR(int timeLimit) : Solver(timeLimit)
-    {
-        std::cout << "Search Method: Depth-First Search with Random Selection, Time Limit: "
-                  << timeLimit << " minutes." << endl;
-    }
-
-    void run(std::chrono::steady_clock::time_point end)
-    {
-        shared_ptr<NodeSelection> selection = make_shared<Random>();
-        Stack s;
-        solve(s, end, selection);
-    }
-};
-
-class Solve_DFSH : public Solver
-{
-public:
-    Solve_DFSH(int timeLimit) : Solver(timeLimit)
-    {
-        std::cout << "Search Method: Depth-First Search with a Node Selection Heuristic, Time Limit: "
-                  << timeLimit << " minutes." << endl;
-    }
-
-    void run(std::chrono::steady_clock::time_point end)
-    {
-        shared_ptr<NodeSelection> selection = make_shared<Heuristic>();
-        Stack s;
-        solve(s, end, selection);
-    }
-};
-
 /*
- * Solve class provides time measurement and function
- * calls to the solver classes.
+ * Running the selected methods in an order, the original 5 of them by default:
  */
-class Solve
+int main(int argc, char **argv)
 {
-public:
-    void start(Solver &s)
+    Benchmark benchmark;
+    if (benchmark.parseArguments(argc, argv) == false)
     {
-        auto start = std::chrono::steady_clock::now();
-        auto begin = start + std::chrono::minutes(s.timeLimit);
-        s.run(begin);
-        auto end = std::chrono::steady_clock::now();
-        auto runtime = std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
-        s.printResults(runtime);
+        benchmark.printUsage();
+        return 1;
     }
-};
-/*
- * Running each method in an order:
- */
-int main(int argc, char **argv)
-{
-    Solve s;
-    Solve_DFS dfs(60);
-    s.start(dfs);
-    Solve_BFS bfs(60);
-    s.start(bfs);
-    Solve_IDS ids(60, 33);
-    s.start(ids);
-    Solve_DFSR dfsr(60);
-    s.start(dfsr);
-    Solve_DFSH dfsh(60);
-    s.start(dfsh);
-};
+    if (benchmark.run() == false)
+        return 1;
+    return 0;
+}